@@ -0,0 +1,1229 @@
+/**
+ * @file benchDriver.c
+ * @brief Unified Linux benchmark driver for the COW, container storage and disk suites
+ *
+ * Runs the workloads of memory_benchmark.c, containerStorage.c and
+ * readWriteCompare.c on Linux with parameter sweeps instead of hard-coded
+ * constants, pins the measuring threads to CPUs, records host metadata and
+ * writes one JSON or CSV report. A previous report can be given as a
+ * baseline; any performance metric that got worse by more than the threshold
+ * is flagged and the driver exits non-zero, so it can gate changes across
+ * hosts. Informational metrics such as the device read/write ratio are
+ * reported but never gated.
+ */
+
+#define _GNU_SOURCE
+#include <errno.h>
+#include <fcntl.h>
+#include <getopt.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <sys/sysmacros.h>
+#include <sys/utsname.h>
+#include <time.h>
+#include <unistd.h>
+
+/**
+ * @brief Maximum entries in one sweep list
+ */
+#define MAX_SWEEP 16
+
+/**
+ * @brief Maximum metrics reported by one benchmark case
+ */
+#define MAX_METRICS 8
+
+/**
+ * @brief Maximum repetitions of one case
+ */
+#define MAX_REPS 32
+
+/**
+ * @brief Maximum worker threads of one disk suite case
+ */
+#define MAX_DISK_THREADS 64
+
+/**
+ * @brief Default regression threshold in percent
+ */
+#define DEFAULT_THRESHOLD_PCT 10.0
+
+/**
+ * @brief Size of the Ubuntu base layer in the container model, as in containerStorage.c
+ */
+#define BASE_LAYER_MB 120
+
+/**
+ * @brief Alignment of disk suite buffers, sufficient for O_DIRECT
+ */
+#define BUFFER_ALIGN 4096
+
+/**
+ * @brief How a metric is judged by the baseline comparison
+ */
+typedef enum {
+    LOWER_IS_BETTER,         /**< Regression when the value grows */
+    HIGHER_IS_BETTER,        /**< Regression when the value shrinks */
+    INFORMATIONAL            /**< Reported only, never gated */
+} Direction;
+
+/**
+ * @brief Names of Direction values in reports
+ */
+static const char* const directionNames[] = { "lower", "higher", "none" };
+
+/**
+ * @brief One measured value of a benchmark case
+ */
+typedef struct {
+    const char* name;        /**< Metric name */
+    const char* unit;        /**< Unit */
+    Direction better;        /**< Direction used for regression checks */
+    double value;            /**< Measured value */
+} Metric;
+
+/**
+ * @brief One row of the report
+ */
+typedef struct {
+    char suite[16];          /**< Suite name */
+    char label[128];         /**< Case parameters, "key=value;key=value" */
+    char metric[32];         /**< Metric name */
+    char unit[8];            /**< Unit */
+    Direction better;        /**< Direction used for regression checks */
+    double value;            /**< Median over repetitions */
+} Row;
+
+/**
+ * @brief Growable list of report rows
+ */
+typedef struct {
+    Row* rows;               /**< Rows */
+    size_t count;            /**< Used rows */
+    size_t capacity;         /**< Allocated rows */
+} Report;
+
+/**
+ * @brief A list of sweep values
+ */
+typedef struct {
+    long long v[MAX_SWEEP];  /**< Values */
+    int n;                   /**< Number of values */
+} Sweep;
+
+/**
+ * @brief Driver configuration
+ */
+typedef struct {
+    int runCow;              /**< Run the COW memory suite */
+    int runContainer;        /**< Run the container storage suite */
+    int runDisk;             /**< Run the disk suite */
+    int reps;                /**< Repetitions per case, median reported */
+    int firstCpu;            /**< Index of the first allowed CPU used for pinning */
+    Sweep cowElements;       /**< COW suite: array sizes in elements */
+    Sweep cowCopies;         /**< COW suite: copies per run */
+    Sweep cowMods;           /**< COW suite: modifications per copy */
+    Sweep containers;        /**< Container suite: container counts */
+    Sweep uniqueMb;          /**< Container suite: unique data per container */
+    Sweep diskBlock;         /**< Disk suite: block sizes */
+    Sweep diskThreads;       /**< Disk suite: worker threads */
+    int diskReadPct;         /**< Disk suite: percentage of reads */
+    int diskSec;             /**< Disk suite: seconds per case */
+    int diskFileMb;          /**< Disk suite: scratch file size */
+    int diskDirect;          /**< Disk suite: use O_DIRECT */
+    const char* diskPath;    /**< Disk suite: scratch file */
+    const char* output;      /**< Report path */
+    const char* baseline;    /**< Baseline report path */
+    double thresholdPct;     /**< Regression threshold */
+} Config;
+
+/**
+ * @brief Returns the monotonic clock in seconds
+ * @return Current time in seconds
+ */
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/**
+ * @brief CPUs the driver may run on, captured before any thread is pinned
+ */
+static cpu_set_t allowedCpus;
+
+/**
+ * @brief Number of failed pin_to_cpu() calls, updated atomically
+ */
+static int pinFailures;
+
+/**
+ * @brief Pins the calling thread to one of the allowed CPUs
+ *
+ * Indices count allowed CPUs only, so under a cpuset or taskset the threads
+ * land on CPUs they may actually use. Failures are counted in pinFailures.
+ *
+ * @param cpu Index into the allowed CPUs, wrapped to their number
+ * @return 1 on success, 0 on failure
+ */
+static int pin_to_cpu(int cpu) {
+    int n = CPU_COUNT(&allowedCpus);
+    int target = n > 0 ? cpu % n : 0;
+    for (int c = 0; n > 0 && c < CPU_SETSIZE; c++) {
+        if (!CPU_ISSET(c, &allowedCpus) || target-- > 0) continue;
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(c, &set);
+        if (pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0) return 1;
+        break;
+    }
+    __atomic_fetch_add(&pinFailures, 1, __ATOMIC_RELAXED);
+    return 0;
+}
+
+/**
+ * @brief xorshift64 generator, deterministic across hosts unlike rand()
+ * @param state Generator state, non-zero
+ * @return Next value
+ */
+static uint64_t next_random(uint64_t* state) {
+    uint64_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    return *state = x;
+}
+
+/* ---------------------------------------------------------------------- */
+/* COW memory suite (memory_benchmark.c)                                   */
+/* ---------------------------------------------------------------------- */
+
+/**
+ * @brief Copy-on-Write array, as in memory_benchmark.c
+ */
+typedef struct {
+    int* data;               /**< Pointer to the shared data array */
+    int* ref_count;          /**< Pointer to the reference count */
+} cow_array;
+
+/**
+ * @brief Creates a new Copy-on-Write array of specified size
+ * @param size Number of elements
+ * @return New COW array, data is NULL on failure
+ */
+static cow_array cow_create(size_t size) {
+    cow_array arr;
+    arr.data = (int*)malloc(size * sizeof(int));
+    arr.ref_count = (int*)malloc(sizeof(int));
+    *(arr.ref_count) = 1;
+    return arr;
+}
+
+/**
+ * @brief Creates a Copy-on-Write copy sharing the source's data
+ * @param src Source array
+ * @return COW copy
+ */
+static cow_array cow_copy(cow_array src) {
+    cow_array dest = src;
+    (*(dest.ref_count))++;
+    return dest;
+}
+
+/**
+ * @brief Gives the array a private copy of its data if it is shared
+ * @param arr Array to make unique
+ * @param size Number of elements
+ * @return 1 on success, 0 if the copy could not be allocated
+ */
+static int cow_ensure_unique(cow_array* arr, size_t size) {
+    if (*(arr->ref_count) > 1) {
+        int* old_data = arr->data;
+        int* data = (int*)malloc(size * sizeof(int));
+        int* ref_count = (int*)malloc(sizeof(int));
+        if (!data || !ref_count) {
+            free(data);
+            free(ref_count);
+            return 0;
+        }
+        memcpy(data, old_data, size * sizeof(int));
+        (*(arr->ref_count))--;
+        arr->data = data;
+        arr->ref_count = ref_count;
+        *(arr->ref_count) = 1;
+    }
+    return 1;
+}
+
+/**
+ * @brief Drops a reference, freeing the data with the last one
+ * @param arr Array to free
+ */
+static void cow_free(cow_array* arr) {
+    (*(arr->ref_count))--;
+    if (*(arr->ref_count) == 0) {
+        free(arr->data);
+        free(arr->ref_count);
+    }
+}
+
+/**
+ * @brief Times full copies followed by sparse modifications
+ * @param size Elements per array
+ * @param copies Number of copies
+ * @param mods Modifications per copy
+ * @return Seconds, or a negative value on allocation failure
+ */
+static double cow_traditional(size_t size, int copies, int mods) {
+    uint64_t rng = 0x2545F4914F6CDD1Dull;
+    int* original = (int*)malloc(size * sizeof(int));
+    int** arrays = (int**)calloc((size_t)copies, sizeof(int*));
+    if (!original || !arrays) {
+        free(original);
+        free(arrays);
+        return -1;
+    }
+    for (size_t i = 0; i < size; i++) original[i] = (int)next_random(&rng);
+
+    double start = now_sec();
+    int ok = 1;
+    for (int i = 0; ok && i < copies; i++) {
+        arrays[i] = (int*)malloc(size * sizeof(int));
+        if (!arrays[i]) ok = 0;
+        else memcpy(arrays[i], original, size * sizeof(int));
+    }
+    for (int i = 0; ok && i < copies; i++) {
+        for (int j = 0; j < mods; j++) {
+            arrays[i][next_random(&rng) % size] = (int)next_random(&rng);
+        }
+    }
+    double elapsed = now_sec() - start;
+
+    free(original);
+    for (int i = 0; i < copies; i++) free(arrays[i]);
+    free(arrays);
+    return ok ? elapsed : -1;
+}
+
+/**
+ * @brief Times COW copies followed by sparse modifications
+ * @param size Elements per array
+ * @param copies Number of copies
+ * @param mods Modifications per copy
+ * @return Seconds, or a negative value on allocation failure
+ */
+static double cow_shared(size_t size, int copies, int mods) {
+    uint64_t rng = 0x2545F4914F6CDD1Dull;
+    cow_array original = cow_create(size);
+    cow_array* arrays = (cow_array*)calloc((size_t)copies, sizeof(cow_array));
+    if (!original.data || !arrays) {
+        free(original.data);
+        free(original.ref_count);
+        free(arrays);
+        return -1;
+    }
+    for (size_t i = 0; i < size; i++) original.data[i] = (int)next_random(&rng);
+
+    double start = now_sec();
+    for (int i = 0; i < copies; i++) arrays[i] = cow_copy(original);
+    int ok = 1;
+    for (int i = 0; ok && i < copies; i++) {
+        // Only the first modification of each copy pays for the private copy
+        if (mods > 0 && !cow_ensure_unique(&arrays[i], size)) ok = 0;
+        for (int j = 0; ok && j < mods; j++) {
+            arrays[i].data[next_random(&rng) % size] = (int)next_random(&rng);
+        }
+    }
+    double elapsed = now_sec() - start;
+
+    cow_free(&original);
+    for (int i = 0; i < copies; i++) cow_free(&arrays[i]);
+    free(arrays);
+    return ok ? elapsed : -1;
+}
+
+/**
+ * @brief Runs one COW suite case
+ * @param size Elements per array
+ * @param copies Number of copies
+ * @param mods Modifications per copy
+ * @param m Metrics to fill
+ * @return Number of metrics, 0 on failure
+ */
+static int run_cow_case(size_t size, int copies, int mods, Metric* m) {
+    double cow = cow_shared(size, copies, mods);
+    double traditional = cow_traditional(size, copies, mods);
+    if (cow < 0 || traditional < 0) return 0;
+
+    m[0] = (Metric){ "traditional_sec", "s", LOWER_IS_BETTER, traditional };
+    m[1] = (Metric){ "cow_sec", "s", LOWER_IS_BETTER, cow };
+    m[2] = (Metric){ "cow_speedup", "x", HIGHER_IS_BETTER, cow > 0 ? traditional / cow : 0 };
+    return 3;
+}
+
+/* ---------------------------------------------------------------------- */
+/* Container storage suite (containerStorage.c)                            */
+/* ---------------------------------------------------------------------- */
+
+/**
+ * @brief Layer of a container image, as in containerStorage.c
+ */
+typedef struct {
+    char id[64];             /**< Layer identifier */
+    size_t size_mb;          /**< Layer size in MB */
+} Layer;
+
+/**
+ * @brief Container referencing its layers, as in containerStorage.c
+ */
+typedef struct {
+    Layer** layers;          /**< Array of layers */
+    int layer_count;         /**< Number of layers */
+} Container;
+
+/**
+ * @brief Builds both storage models and reports their size
+ *
+ * Without COW every container owns a full base layer; with COW all
+ * containers share one base layer and own only their unique layer.
+ *
+ * @param count Number of containers
+ * @param uniqueMb Unique data per container
+ * @param m Metrics to fill
+ * @return Number of metrics, 0 on failure
+ */
+static int run_container_case(int count, int uniqueMb, Metric* m) {
+    Container* noCow = (Container*)calloc((size_t)count, sizeof(Container));
+    Container* cow = (Container*)calloc((size_t)count, sizeof(Container));
+    Layer* shared = (Layer*)calloc(1, sizeof(Layer));
+    if (!noCow || !cow || !shared) {
+        free(noCow);
+        free(cow);
+        free(shared);
+        return 0;
+    }
+    strcpy(shared->id, "ubuntu:latest");
+    shared->size_mb = BASE_LAYER_MB;
+
+    double start = now_sec();
+    size_t storageNoCow = 0, storageCow = shared->size_mb;
+    for (int i = 0; i < count; i++) {
+        noCow[i].layer_count = 1;
+        noCow[i].layers = (Layer**)malloc(sizeof(Layer*));
+        noCow[i].layers[0] = (Layer*)malloc(sizeof(Layer));
+        strcpy(noCow[i].layers[0]->id, "ubuntu:latest");
+        noCow[i].layers[0]->size_mb = BASE_LAYER_MB;
+        storageNoCow += noCow[i].layers[0]->size_mb;
+
+        cow[i].layer_count = 2;
+        cow[i].layers = (Layer**)malloc(sizeof(Layer*) * 2);
+        cow[i].layers[0] = shared;
+        cow[i].layers[1] = (Layer*)malloc(sizeof(Layer));
+        snprintf(cow[i].layers[1]->id, sizeof(cow[i].layers[1]->id), "container-%d-layer", i + 1);
+        cow[i].layers[1]->size_mb = (size_t)uniqueMb;
+        storageCow += cow[i].layers[1]->size_mb;
+    }
+    double elapsed = now_sec() - start;
+
+    for (int i = 0; i < count; i++) {
+        free(noCow[i].layers[0]);
+        free(noCow[i].layers);
+        free(cow[i].layers[1]);
+        free(cow[i].layers);
+    }
+    free(noCow);
+    free(cow);
+    free(shared);
+
+    // Matches containerStorage.c, where the unique layer only exists with COW
+    m[0] = (Metric){ "storage_no_cow_mb", "MB", LOWER_IS_BETTER, (double)storageNoCow };
+    m[1] = (Metric){ "storage_cow_mb", "MB", LOWER_IS_BETTER, (double)storageCow };
+    m[2] = (Metric){ "reduction_pct", "%", HIGHER_IS_BETTER,
+                     100.0 * (1.0 - (double)storageCow / (double)storageNoCow) };
+    m[3] = (Metric){ "build_us_per_container", "us", LOWER_IS_BETTER, elapsed * 1e6 / count };
+    return 4;
+}
+
+/* ---------------------------------------------------------------------- */
+/* Disk suite (readWriteCompare.c)                                         */
+/* ---------------------------------------------------------------------- */
+
+/**
+ * @brief Device counters from /proc/diskstats
+ */
+typedef struct {
+    uint64_t readOps;        /**< Reads completed */
+    uint64_t writeOps;       /**< Writes completed */
+} DiskStats;
+
+/**
+ * @brief Reads the counters of the device backing a file system
+ * @param dev Device number (st_dev)
+ * @param[out] stats Counters
+ * @return 1 if the device was found
+ */
+static int read_disk_stats(dev_t dev, DiskStats* stats) {
+    FILE* f = fopen("/proc/diskstats", "r");
+    if (!f) return 0;
+    char line[512];
+    int found = 0;
+    while (!found && fgets(line, sizeof(line), f)) {
+        unsigned maj, min;
+        unsigned long long rd, wr;
+        if (sscanf(line, "%u %u %*s %llu %*u %*u %*u %llu", &maj, &min, &rd, &wr) != 4) continue;
+        if (maj != major(dev) || min != minor(dev)) continue;
+        stats->readOps = rd;
+        stats->writeOps = wr;
+        found = 1;
+    }
+    fclose(f);
+    return found;
+}
+
+/**
+ * @brief Arguments and results of one disk suite worker
+ */
+typedef struct {
+    int fd;                  /**< Scratch file */
+    int cpu;                 /**< CPU to pin to */
+    uint32_t blockSize;      /**< Request size */
+    uint64_t blocks;         /**< Blocks in the scratch file */
+    int readPct;             /**< Percentage of reads */
+    double deadline;         /**< Monotonic time to stop at */
+    uint64_t seed;           /**< Generator seed */
+    uint64_t ops;            /**< Completed requests */
+    uint64_t errors;         /**< Failed requests */
+} DiskWorker;
+
+/**
+ * @brief Disk suite worker: random pread/pwrite mix until the deadline
+ * @param arg DiskWorker
+ * @return NULL
+ */
+static void* disk_worker(void* arg) {
+    DiskWorker* w = (DiskWorker*)arg;
+    pin_to_cpu(w->cpu);
+    void* buf = NULL;
+    if (posix_memalign(&buf, BUFFER_ALIGN, w->blockSize) != 0) {
+        w->errors++;
+        return NULL;
+    }
+    memset(buf, 0xA5, w->blockSize);
+
+    while (now_sec() < w->deadline) {
+        for (int batch = 0; batch < 64; batch++) {
+            off_t off = (off_t)(next_random(&w->seed) % w->blocks) * w->blockSize;
+            int isRead = (int)(next_random(&w->seed) % 100) < w->readPct;
+            ssize_t n = isRead ? pread(w->fd, buf, w->blockSize, off)
+                               : pwrite(w->fd, buf, w->blockSize, off);
+            if (n == (ssize_t)w->blockSize) w->ops++;
+            else w->errors++;
+        }
+    }
+    free(buf);
+    return NULL;
+}
+
+/**
+ * @brief Creates the disk suite scratch file if missing or too small
+ * @param cfg Driver configuration
+ * @return 1 on success
+ */
+static int prepare_scratch(const Config* cfg) {
+    uint64_t size = (uint64_t)cfg->diskFileMb * 1024 * 1024;
+    struct stat st;
+    if (stat(cfg->diskPath, &st) == 0 && (uint64_t)st.st_size >= size) return 1;
+
+    int fd = open(cfg->diskPath, O_WRONLY | O_CREAT, 0644);
+    if (fd < 0) return 0;
+    char* buf = (char*)malloc(1024 * 1024);
+    if (!buf) {
+        close(fd);
+        return 0;
+    }
+    memset(buf, 0x5A, 1024 * 1024);
+    int ok = 1;
+    for (uint64_t off = 0; ok && off < size; off += 1024 * 1024) {
+        ok = pwrite(fd, buf, 1024 * 1024, (off_t)off) == 1024 * 1024;
+    }
+    fsync(fd);
+    free(buf);
+    close(fd);
+    return ok;
+}
+
+/**
+ * @brief Runs one disk suite case and measures the device ratio
+ * @param cfg Driver configuration
+ * @param blockSize Request size
+ * @param threads Worker threads
+ * @param m Metrics to fill
+ * @return Number of metrics, 0 on failure
+ */
+static int run_disk_case(const Config* cfg, uint32_t blockSize, int threads, Metric* m) {
+    int fd = open(cfg->diskPath, O_RDWR | (cfg->diskDirect ? O_DIRECT : 0));
+    if (fd < 0) return 0;
+    struct stat st;
+    fstat(fd, &st);
+
+    DiskWorker workers[MAX_DISK_THREADS];
+    pthread_t ids[MAX_DISK_THREADS];
+    if (threads > MAX_DISK_THREADS) threads = MAX_DISK_THREADS;
+
+    DiskStats before, after;
+    int haveDisk = read_disk_stats(st.st_dev, &before);
+    double start = now_sec();
+    int started = 0;
+    for (int i = 0; i < threads; i++) {
+        workers[i] = (DiskWorker){ fd, cfg->firstCpu + i, blockSize,
+                                   (uint64_t)st.st_size / blockSize, cfg->diskReadPct,
+                                   start + cfg->diskSec, 0x9E3779B97F4A7C15ull * (i + 1), 0, 0 };
+        if (pthread_create(&ids[i], NULL, disk_worker, &workers[i]) != 0) break;
+        started++;
+    }
+    uint64_t ops = 0, errors = 0;
+    for (int i = 0; i < started; i++) {
+        pthread_join(ids[i], NULL);
+        ops += workers[i].ops;
+        errors += workers[i].errors;
+    }
+    if (!cfg->diskDirect) fsync(fd);
+    double elapsed = now_sec() - start;
+    close(fd);
+    if (started == 0 || errors > 0) return 0;
+
+    int n = 0;
+    m[n++] = (Metric){ "iops", "ops/s", HIGHER_IS_BETTER, ops / elapsed };
+    m[n++] = (Metric){ "mb_per_sec", "MB/s", HIGHER_IS_BETTER, ops * (double)blockSize / (1024.0 * 1024.0) / elapsed };
+    // Same ratio readWriteCompare.c reports, measured on the backing device. It
+    // describes the workload rather than its speed, so it is never gated, and it
+    // is always emitted (0 without device writes) to keep the metric count stable.
+    double ratio = 0;
+    if (haveDisk && read_disk_stats(st.st_dev, &after) && after.writeOps > before.writeOps) {
+        ratio = (double)(after.readOps - before.readOps) / (double)(after.writeOps - before.writeOps);
+    }
+    m[n++] = (Metric){ "device_read_write_ratio", ":1", INFORMATIONAL, ratio };
+    return n;
+}
+
+/* ---------------------------------------------------------------------- */
+/* Report                                                                  */
+/* ---------------------------------------------------------------------- */
+
+/**
+ * @brief Appends a row to the report
+ * @param r Report
+ * @param row Row
+ */
+static void report_add(Report* r, const Row* row) {
+    if (r->count == r->capacity) {
+        r->capacity = r->capacity ? r->capacity * 2 : 64;
+        r->rows = (Row*)realloc(r->rows, r->capacity * sizeof(Row));
+        if (!r->rows) {
+            printf("Error: Could not grow report\n");
+            exit(1);
+        }
+    }
+    r->rows[r->count++] = *row;
+}
+
+/**
+ * @brief Compares two doubles for qsort
+ */
+static int compare_double(const void* a, const void* b) {
+    double x = *(const double*)a, y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+/**
+ * @brief Repeats a case and adds the median of every metric to the report
+ * @param r Report
+ * @param suite Suite name
+ * @param label Case parameters
+ * @param reps Repetitions
+ * @param run Case runner returning the metric count
+ * @param ctx Runner context
+ * @return 1 on success, 0 if a repetition failed and the case was not recorded
+ */
+static int record_case(Report* r, const char* suite, const char* label, int reps,
+                        int (*run)(const void* ctx, Metric* m), const void* ctx) {
+    double values[MAX_METRICS][MAX_REPS];
+    Metric m[MAX_METRICS];
+    int count = 0;
+
+    printf("  %-10s %-48s", suite, label);
+    fflush(stdout);
+    for (int rep = 0; rep < reps; rep++) {
+        int n = run(ctx, m);
+        if (n == 0 || (count && n != count)) {
+            printf(" FAILED\n");
+            return 0;
+        }
+        count = n;
+        for (int i = 0; i < n; i++) values[i][rep] = m[i].value;
+    }
+
+    for (int i = 0; i < count; i++) {
+        qsort(values[i], (size_t)reps, sizeof(double), compare_double);
+        Row row;
+        memset(&row, 0, sizeof(row));
+        snprintf(row.suite, sizeof(row.suite), "%s", suite);
+        snprintf(row.label, sizeof(row.label), "%s", label);
+        snprintf(row.metric, sizeof(row.metric), "%s", m[i].name);
+        snprintf(row.unit, sizeof(row.unit), "%s", m[i].unit);
+        row.better = m[i].better;
+        row.value = values[i][reps / 2];
+        report_add(r, &row);
+        printf(" %s=%.4g", m[i].name, row.value);
+    }
+    printf("\n");
+    return 1;
+}
+
+/**
+ * @brief Context of one COW case
+ */
+typedef struct {
+    size_t size;             /**< Elements per array */
+    int copies;              /**< Copies */
+    int mods;                /**< Modifications per copy */
+} CowCase;
+
+/**
+ * @brief record_case() adapter for the COW suite
+ */
+static int cow_runner(const void* ctx, Metric* m) {
+    const CowCase* c = (const CowCase*)ctx;
+    return run_cow_case(c->size, c->copies, c->mods, m);
+}
+
+/**
+ * @brief Context of one container case
+ */
+typedef struct {
+    int count;               /**< Containers */
+    int uniqueMb;            /**< Unique MB per container */
+} ContainerCase;
+
+/**
+ * @brief record_case() adapter for the container suite
+ */
+static int container_runner(const void* ctx, Metric* m) {
+    const ContainerCase* c = (const ContainerCase*)ctx;
+    return run_container_case(c->count, c->uniqueMb, m);
+}
+
+/**
+ * @brief Context of one disk case
+ */
+typedef struct {
+    const Config* cfg;       /**< Driver configuration */
+    uint32_t blockSize;      /**< Request size */
+    int threads;             /**< Worker threads */
+} DiskCase;
+
+/**
+ * @brief record_case() adapter for the disk suite
+ */
+static int disk_runner(const void* ctx, Metric* m) {
+    const DiskCase* c = (const DiskCase*)ctx;
+    return run_disk_case(c->cfg, c->blockSize, c->threads, m);
+}
+
+/**
+ * @brief Reads the first line of a file starting with a key
+ * @param path File
+ * @param key Line prefix
+ * @param[out] out Rest of the line after the prefix and separators
+ * @param size Size of out
+ */
+static void read_keyed_line(const char* path, const char* key, char* out, size_t size) {
+    snprintf(out, size, "unknown");
+    FILE* f = fopen(path, "r");
+    if (!f) return;
+    char line[512];
+    size_t len = strlen(key);
+    while (fgets(line, sizeof(line), f)) {
+        if (strncmp(line, key, len) != 0) continue;
+        char* p = line + len;
+        while (*p == ' ' || *p == '\t' || *p == ':') p++;
+        p[strcspn(p, "\n")] = '\0';
+        snprintf(out, size, "%s", p);
+        break;
+    }
+    fclose(f);
+}
+
+/**
+ * @brief Host metadata recorded with every report
+ */
+typedef struct {
+    char hostname[64];       /**< Host name */
+    char cpuModel[128];      /**< CPU model */
+    long cpus;               /**< Online CPUs */
+    int cpusAllowed;         /**< CPUs the driver may run on */
+    int pinFailures;         /**< Threads that could not be pinned */
+    char kernel[192];        /**< Kernel release and version */
+    char thp[128];           /**< Transparent huge page mode */
+    char memTotal[32];       /**< Total memory */
+    char timestamp[32];      /**< Report time, UTC */
+} HostInfo;
+
+/**
+ * @brief Collects host metadata
+ * @param h Metadata to fill
+ */
+static void collect_host(HostInfo* h) {
+    memset(h, 0, sizeof(*h));
+    gethostname(h->hostname, sizeof(h->hostname) - 1);
+    read_keyed_line("/proc/cpuinfo", "model name", h->cpuModel, sizeof(h->cpuModel));
+    h->cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    h->cpusAllowed = CPU_COUNT(&allowedCpus);
+
+    struct utsname u;
+    if (uname(&u) == 0) snprintf(h->kernel, sizeof(h->kernel), "%s %s", u.release, u.version);
+
+    // The active mode is the bracketed one, e.g. "always [madvise] never"
+    char thp[128];
+    read_keyed_line("/sys/kernel/mm/transparent_hugepage/enabled", "", thp, sizeof(thp));
+    char* open = strchr(thp, '[');
+    char* close = open ? strchr(open, ']') : NULL;
+    if (open && close) {
+        *close = '\0';
+        snprintf(h->thp, sizeof(h->thp), "%s", open + 1);
+    } else {
+        snprintf(h->thp, sizeof(h->thp), "%s", thp);
+    }
+    read_keyed_line("/proc/meminfo", "MemTotal", h->memTotal, sizeof(h->memTotal));
+
+    time_t t = time(NULL);
+    strftime(h->timestamp, sizeof(h->timestamp), "%Y-%m-%dT%H:%M:%SZ", gmtime(&t));
+}
+
+/**
+ * @brief Writes a string as a JSON string literal
+ * @param f Output
+ * @param s String
+ */
+static void json_string(FILE* f, const char* s) {
+    fputc('"', f);
+    for (; *s; s++) {
+        if (*s == '"' || *s == '\\') fputc('\\', f);
+        if ((unsigned char)*s >= 0x20) fputc(*s, f);
+    }
+    fputc('"', f);
+}
+
+/**
+ * @brief Returns whether a path ends in ".csv"
+ */
+static int is_csv(const char* path) {
+    size_t n = strlen(path);
+    return n >= 4 && strcmp(path + n - 4, ".csv") == 0;
+}
+
+/**
+ * @brief Writes the report as JSON (one result per line) or CSV
+ * @param path Output path
+ * @param h Host metadata
+ * @param r Report
+ * @return 1 on success
+ */
+static int write_report(const char* path, const HostInfo* h, const Report* r) {
+    FILE* f = fopen(path, "w");
+    if (!f) {
+        printf("Error writing %s: %s\n", path, strerror(errno));
+        return 0;
+    }
+
+    if (is_csv(path)) {
+        fprintf(f, "# hostname: %s\n# cpu_model: %s\n# cpus: %ld\n# cpus_allowed: %d\n"
+                   "# pin_failures: %d\n# kernel: %s\n# thp: %s\n# mem_total: %s\n# timestamp: %s\n",
+                h->hostname, h->cpuModel, h->cpus, h->cpusAllowed, h->pinFailures, h->kernel,
+                h->thp, h->memTotal, h->timestamp);
+        fprintf(f, "suite,case,metric,value,unit,better\n");
+        for (size_t i = 0; i < r->count; i++) {
+            const Row* row = &r->rows[i];
+            fprintf(f, "%s,%s,%s,%.17g,%s,%s\n", row->suite, row->label, row->metric,
+                    row->value, row->unit, directionNames[row->better]);
+        }
+    } else {
+        fprintf(f, "{\n  \"host\": {\"hostname\": ");
+        json_string(f, h->hostname);
+        fprintf(f, ", \"cpu_model\": ");
+        json_string(f, h->cpuModel);
+        fprintf(f, ", \"cpus\": %ld, \"cpus_allowed\": %d, \"pin_failures\": %d, \"kernel\": ",
+                h->cpus, h->cpusAllowed, h->pinFailures);
+        json_string(f, h->kernel);
+        fprintf(f, ", \"thp\": ");
+        json_string(f, h->thp);
+        fprintf(f, ", \"mem_total\": ");
+        json_string(f, h->memTotal);
+        fprintf(f, ", \"timestamp\": ");
+        json_string(f, h->timestamp);
+        fprintf(f, "},\n  \"results\": [\n");
+        for (size_t i = 0; i < r->count; i++) {
+            const Row* row = &r->rows[i];
+            fprintf(f, "    {\"suite\": \"%s\", \"case\": \"%s\", \"metric\": \"%s\", "
+                       "\"value\": %.17g, \"unit\": \"%s\", \"better\": \"%s\"}%s\n",
+                    row->suite, row->label, row->metric, row->value, row->unit,
+                    directionNames[row->better], i + 1 < r->count ? "," : "");
+        }
+        fprintf(f, "  ]\n}\n");
+    }
+    fclose(f);
+    return 1;
+}
+
+/**
+ * @brief Extracts a JSON string field from a single-line object
+ * @param line Input line
+ * @param key Field name
+ * @param out Value
+ * @param size Size of out
+ * @return 1 if found
+ */
+static int json_field(const char* line, const char* key, char* out, size_t size) {
+    char pattern[40];
+    snprintf(pattern, sizeof(pattern), "\"%s\": ", key);
+    const char* p = strstr(line, pattern);
+    if (!p) return 0;
+    p += strlen(pattern);
+    if (*p == '"') {
+        p++;
+        size_t n = strcspn(p, "\"");
+        if (n >= size) n = size - 1;
+        memcpy(out, p, n);
+        out[n] = '\0';
+    } else {
+        size_t n = strcspn(p, ",}");
+        if (n >= size) n = size - 1;
+        memcpy(out, p, n);
+        out[n] = '\0';
+    }
+    return 1;
+}
+
+/**
+ * @brief Loads a report written by write_report()
+ * @param path Report path, JSON or CSV
+ * @param[out] r Rows
+ * @return 1 on success
+ */
+static int load_report(const char* path, Report* r) {
+    FILE* f = fopen(path, "r");
+    if (!f) {
+        printf("Error opening baseline %s: %s\n", path, strerror(errno));
+        return 0;
+    }
+    char line[1024];
+    while (fgets(line, sizeof(line), f)) {
+        Row row;
+        memset(&row, 0, sizeof(row));
+        char value[64], better[16];
+        if (strstr(line, "\"suite\": ")) {
+            if (!json_field(line, "suite", row.suite, sizeof(row.suite)) ||
+                !json_field(line, "case", row.label, sizeof(row.label)) ||
+                !json_field(line, "metric", row.metric, sizeof(row.metric)) ||
+                !json_field(line, "value", value, sizeof(value)) ||
+                !json_field(line, "better", better, sizeof(better))) continue;
+        } else if (line[0] != '#' && strncmp(line, "suite,", 6) != 0) {
+            if (sscanf(line, "%15[^,],%127[^,],%31[^,],%63[^,],%7[^,],%15[^,\n]",
+                       row.suite, row.label, row.metric, value, row.unit, better) != 6) continue;
+        } else {
+            continue;
+        }
+        row.value = atof(value);
+        row.better = INFORMATIONAL;
+        for (int d = LOWER_IS_BETTER; d <= INFORMATIONAL; d++) {
+            if (strcmp(better, directionNames[d]) == 0) row.better = (Direction)d;
+        }
+        report_add(r, &row);
+    }
+    fclose(f);
+    return 1;
+}
+
+/**
+ * @brief Finds the row of a report with the same suite, case and metric
+ * @param r Report to search
+ * @param key Row to match
+ * @return Matching row, NULL if there is none
+ */
+static const Row* find_row(const Report* r, const Row* key) {
+    for (size_t i = 0; i < r->count; i++) {
+        const Row* cand = &r->rows[i];
+        if (strcmp(cand->suite, key->suite) == 0 && strcmp(cand->label, key->label) == 0 &&
+            strcmp(cand->metric, key->metric) == 0) return cand;
+    }
+    return NULL;
+}
+
+/**
+ * @brief Compares the report against a baseline
+ *
+ * A gated baseline metric missing from the current report, e.g. because its
+ * case failed or was not run, counts as a regression.
+ *
+ * @param current Current report
+ * @param baseline Baseline report
+ * @param thresholdPct Allowed worsening in percent
+ * @return Number of regressions, missing metrics included
+ */
+static int compare_reports(const Report* current, const Report* baseline, double thresholdPct) {
+    int regressions = 0, compared = 0, missing = 0;
+    printf("\nComparison against baseline (threshold %.1f%%):\n", thresholdPct);
+    printf("  %-10s %-40s %-24s %12s %12s %9s\n", "SUITE", "CASE", "METRIC", "BASELINE", "CURRENT", "CHANGE");
+    for (size_t i = 0; i < current->count; i++) {
+        const Row* c = &current->rows[i];
+        const Row* b = find_row(baseline, c);
+        if (c->better == INFORMATIONAL || !b || b->value == 0) continue;
+
+        compared++;
+        double change = 100.0 * (c->value - b->value) / (b->value < 0 ? -b->value : b->value);
+        double worse = c->better == HIGHER_IS_BETTER ? -change : change;
+        int regressed = worse > thresholdPct;
+        regressions += regressed;
+        printf("  %-10s %-40.40s %-24s %12.4g %12.4g %+8.1f%%%s\n", c->suite, c->label, c->metric,
+               b->value, c->value, change, regressed ? "  REGRESSION" : "");
+    }
+    for (size_t i = 0; i < baseline->count; i++) {
+        const Row* b = &baseline->rows[i];
+        if (b->better == INFORMATIONAL || find_row(current, b)) continue;
+        missing++;
+        printf("  %-10s %-40.40s %-24s %12.4g %12s %9s  MISSING\n", b->suite, b->label, b->metric,
+               b->value, "-", "-");
+    }
+    printf("%d metrics compared, %d regressions, %d missing\n", compared, regressions, missing);
+    return regressions + missing;
+}
+
+/* ---------------------------------------------------------------------- */
+/* Command line                                                            */
+/* ---------------------------------------------------------------------- */
+
+/**
+ * @brief Parses a comma separated list of integers
+ * @param text Input, e.g. "1,4,16"
+ * @param[out] s Sweep
+ * @return 1 if at least one positive value was parsed
+ */
+static int parse_sweep(const char* text, Sweep* s) {
+    s->n = 0;
+    const char* p = text;
+    while (*p && s->n < MAX_SWEEP) {
+        char* end;
+        long long v = strtoll(p, &end, 10);
+        if (end == p || v <= 0) return 0;
+        s->v[s->n++] = v;
+        p = *end == ',' ? end + 1 : end;
+        if (*end && *end != ',') return 0;
+    }
+    return s->n > 0;
+}
+
+/**
+ * @brief Prints command line usage
+ * @param prog Program name
+ */
+static void usage(const char* prog) {
+    printf("Usage: %s [options]\n", prog);
+    printf("  --suites LIST         cow,container,disk (default all)\n");
+    printf("  --output FILE         Report path, .csv for CSV, JSON otherwise (default bench_report.json)\n");
+    printf("  --baseline FILE       Compare against an earlier report\n");
+    printf("  --threshold PCT       Regression threshold (default %.0f%%)\n", DEFAULT_THRESHOLD_PCT);
+    printf("  --reps N              Repetitions per case, median reported (default 3)\n");
+    printf("  --cpu N               First allowed CPU to pin to, counted within the affinity mask (default 0)\n");
+    printf("  --cow-elements LIST   Array sizes in elements (default 1048576,4194304)\n");
+    printf("  --cow-copies LIST     Copies per run (default 8)\n");
+    printf("  --cow-mods LIST       Modifications per copy (default 2400)\n");
+    printf("  --containers LIST     Container counts (default 10,100,1000)\n");
+    printf("  --unique-mb LIST      Unique MB per container (default 3)\n");
+    printf("  --disk-file FILE      Scratch file (default bench_scratch.dat)\n");
+    printf("  --disk-mb N           Scratch file size in MB (default 256)\n");
+    printf("  --disk-block LIST     Block sizes in bytes (default 4096,65536)\n");
+    printf("  --disk-threads LIST   Worker threads (default 1,4)\n");
+    printf("  --disk-read-pct N     Percentage of reads (default 70)\n");
+    printf("  --disk-sec N          Seconds per disk case (default 5)\n");
+    printf("  --disk-direct         Use O_DIRECT\n");
+}
+
+/**
+ * @brief Main program entry point
+ *
+ * Runs the selected suites over their parameter sweeps, writes the report
+ * and compares it with the baseline if one was given.
+ *
+ * @return 0 on success, 1 on failure or if a case failed, 3 if a regression was detected
+ */
+int main(int argc, char** argv) {
+    Config cfg;
+    memset(&cfg, 0, sizeof(cfg));
+    cfg.runCow = cfg.runContainer = cfg.runDisk = 1;
+    cfg.reps = 3;
+    cfg.diskReadPct = 70;
+    cfg.diskSec = 5;
+    cfg.diskFileMb = 256;
+    cfg.diskPath = "bench_scratch.dat";
+    cfg.output = "bench_report.json";
+    cfg.thresholdPct = DEFAULT_THRESHOLD_PCT;
+    parse_sweep("1048576,4194304", &cfg.cowElements);
+    parse_sweep("8", &cfg.cowCopies);
+    parse_sweep("2400", &cfg.cowMods);
+    parse_sweep("10,100,1000", &cfg.containers);
+    parse_sweep("3", &cfg.uniqueMb);
+    parse_sweep("4096,65536", &cfg.diskBlock);
+    parse_sweep("1,4", &cfg.diskThreads);
+
+    static const struct option options[] = {
+        { "suites", required_argument, NULL, 's' },
+        { "output", required_argument, NULL, 'o' },
+        { "baseline", required_argument, NULL, 'b' },
+        { "threshold", required_argument, NULL, 't' },
+        { "reps", required_argument, NULL, 'r' },
+        { "cpu", required_argument, NULL, 'c' },
+        { "cow-elements", required_argument, NULL, 1 },
+        { "cow-copies", required_argument, NULL, 2 },
+        { "cow-mods", required_argument, NULL, 3 },
+        { "containers", required_argument, NULL, 4 },
+        { "unique-mb", required_argument, NULL, 5 },
+        { "disk-file", required_argument, NULL, 6 },
+        { "disk-mb", required_argument, NULL, 7 },
+        { "disk-block", required_argument, NULL, 8 },
+        { "disk-threads", required_argument, NULL, 9 },
+        { "disk-read-pct", required_argument, NULL, 10 },
+        { "disk-sec", required_argument, NULL, 11 },
+        { "disk-direct", no_argument, NULL, 12 },
+        { "help", no_argument, NULL, 'h' },
+        { NULL, 0, NULL, 0 }
+    };
+
+    int opt, ok = 1;
+    while (ok && (opt = getopt_long(argc, argv, "s:o:b:t:r:c:h", options, NULL)) != -1) {
+        switch (opt) {
+        case 's':
+            cfg.runCow = strstr(optarg, "cow") != NULL;
+            cfg.runContainer = strstr(optarg, "container") != NULL;
+            cfg.runDisk = strstr(optarg, "disk") != NULL;
+            break;
+        case 'o': cfg.output = optarg; break;
+        case 'b': cfg.baseline = optarg; break;
+        case 't': cfg.thresholdPct = atof(optarg); break;
+        case 'r': cfg.reps = atoi(optarg); break;
+        case 'c': cfg.firstCpu = atoi(optarg); break;
+        case 1: ok = parse_sweep(optarg, &cfg.cowElements); break;
+        case 2: ok = parse_sweep(optarg, &cfg.cowCopies); break;
+        case 3: ok = parse_sweep(optarg, &cfg.cowMods); break;
+        case 4: ok = parse_sweep(optarg, &cfg.containers); break;
+        case 5: ok = parse_sweep(optarg, &cfg.uniqueMb); break;
+        case 6: cfg.diskPath = optarg; break;
+        case 7: cfg.diskFileMb = atoi(optarg); break;
+        case 8: ok = parse_sweep(optarg, &cfg.diskBlock); break;
+        case 9: ok = parse_sweep(optarg, &cfg.diskThreads); break;
+        case 10: cfg.diskReadPct = atoi(optarg); break;
+        case 11: cfg.diskSec = atoi(optarg); break;
+        case 12: cfg.diskDirect = 1; break;
+        default:
+            usage(argv[0]);
+            return opt == 'h' ? 0 : 1;
+        }
+    }
+    if (!ok || cfg.reps <= 0 || cfg.reps > MAX_REPS || cfg.firstCpu < 0 || cfg.diskSec <= 0 ||
+        cfg.diskFileMb <= 0 || cfg.diskReadPct < 0 || cfg.diskReadPct > 100 ||
+        !(cfg.runCow || cfg.runContainer || cfg.runDisk)) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    if (sched_getaffinity(0, sizeof(allowedCpus), &allowedCpus) != 0) CPU_ZERO(&allowedCpus);
+    HostInfo host;
+    collect_host(&host);
+    printf("Unified Benchmark Driver for Linux\n");
+    printf("----------------------------------\n");
+    printf("Host: %s, %s x%ld (%d allowed)\n", host.hostname, host.cpuModel, host.cpus,
+           host.cpusAllowed);
+    printf("Kernel: %s\n", host.kernel);
+    printf("THP: %s, memory: %s\n\n", host.thp, host.memTotal);
+
+    // Single-threaded suites run on the first CPU; disk workers spread from there
+    if (!pin_to_cpu(cfg.firstCpu)) printf("Warning: could not pin to CPU %d\n", cfg.firstCpu);
+
+    Report report;
+    memset(&report, 0, sizeof(report));
+    char label[128];
+    int failedCases = 0;
+
+    if (cfg.runCow) {
+        for (int a = 0; a < cfg.cowElements.n; a++)
+        for (int b = 0; b < cfg.cowCopies.n; b++)
+        for (int c = 0; c < cfg.cowMods.n; c++) {
+            CowCase cc = { (size_t)cfg.cowElements.v[a], (int)cfg.cowCopies.v[b], (int)cfg.cowMods.v[c] };
+            snprintf(label, sizeof(label), "elements=%zu;copies=%d;mods=%d", cc.size, cc.copies, cc.mods);
+            failedCases += !record_case(&report, "cow", label, cfg.reps, cow_runner, &cc);
+        }
+    }
+    if (cfg.runContainer) {
+        for (int a = 0; a < cfg.containers.n; a++)
+        for (int b = 0; b < cfg.uniqueMb.n; b++) {
+            ContainerCase cc = { (int)cfg.containers.v[a], (int)cfg.uniqueMb.v[b] };
+            snprintf(label, sizeof(label), "containers=%d;unique_mb=%d", cc.count, cc.uniqueMb);
+            failedCases += !record_case(&report, "container", label, cfg.reps, container_runner, &cc);
+        }
+    }
+    if (cfg.runDisk) {
+        if (!prepare_scratch(&cfg)) {
+            printf("Error preparing %s: %s\n", cfg.diskPath, strerror(errno));
+            return 1;
+        }
+        // Reject sizes no worker could issue instead of reporting them as failed cases
+        struct stat st;
+        long long fileBytes = stat(cfg.diskPath, &st) == 0 ? (long long)st.st_size : 0;
+        for (int a = 0; a < cfg.diskBlock.n; a++) {
+            long long block = cfg.diskBlock.v[a];
+            if (block > fileBytes) {
+                printf("Error: --disk-block %lld is larger than %s (%lld bytes)\n", block,
+                       cfg.diskPath, fileBytes);
+                return 1;
+            }
+            if (cfg.diskDirect && block % 512 != 0) {
+                printf("Error: --disk-block %lld is not a multiple of 512, required by --disk-direct\n",
+                       block);
+                return 1;
+            }
+        }
+        for (int a = 0; a < cfg.diskBlock.n; a++)
+        for (int b = 0; b < cfg.diskThreads.n; b++) {
+            DiskCase dc = { &cfg, (uint32_t)cfg.diskBlock.v[a], (int)cfg.diskThreads.v[b] };
+            snprintf(label, sizeof(label), "block=%u;threads=%d;read_pct=%d;%s", dc.blockSize,
+                     dc.threads, cfg.diskReadPct, cfg.diskDirect ? "direct" : "buffered");
+            failedCases += !record_case(&report, "disk", label, cfg.reps, disk_runner, &dc);
+        }
+    }
+
+    host.pinFailures = __atomic_load_n(&pinFailures, __ATOMIC_RELAXED);
+    if (host.pinFailures > 0) {
+        printf("\nWarning: %d threads could not be pinned; results may be noisier\n", host.pinFailures);
+    }
+    if (!write_report(cfg.output, &host, &report)) return 1;
+    printf("\nReport written to %s (%zu results)\n", cfg.output, report.count);
+
+    int rc = 0;
+    if (failedCases > 0) {
+        printf("Error: %d cases failed and are missing from the report\n", failedCases);
+        rc = 1;
+    }
+    if (cfg.baseline) {
+        Report baseline;
+        memset(&baseline, 0, sizeof(baseline));
+        if (!load_report(cfg.baseline, &baseline)) return 1;
+        if (compare_reports(&report, &baseline, cfg.thresholdPct) > 0 && rc == 0) rc = 3;
+        free(baseline.rows);
+    }
+    free(report.rows);
+    return rc;
+}
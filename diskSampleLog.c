@@ -0,0 +1,1033 @@
+/**
+ * @file diskSampleLog.c
+ * @brief Linux binary time-series log of disk samples, with replay and summary
+ *
+ * Records /proc/diskstats counters of one device at a fixed interval into a
+ * compact ring file and reads such files back far faster than real time.
+ *
+ * File layout: one header page followed by fixed-size blocks used as a ring.
+ * Each block starts with an absolute keyframe sample; later samples store the
+ * delta-of-delta of the timestamp and only the counters that changed, all as
+ * zigzag varints. An idle sample therefore costs about three bytes. Because
+ * every block is self-contained, the oldest block can be overwritten without
+ * breaking the rest of the log.
+ *
+ * The file is mmap'd and samples are encoded straight into the mapped block,
+ * so appending issues no system call and a sample survives a crash of the
+ * recorder as soon as it is appended. Repeated writes to the open block only
+ * dirty the same page, which the kernel writes back once per writeback period.
+ */
+
+#define _GNU_SOURCE
+#include <errno.h>
+#include <fcntl.h>
+#include <getopt.h>
+#include <signal.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+/**
+ * @brief Magic bytes at the start of a log file
+ */
+#define LOG_MAGIC "DSKLOG01"
+
+/**
+ * @brief Size of the header page and of every ring block
+ */
+#define BLOCK_SIZE 4096
+
+/**
+ * @brief Default sample interval in milliseconds
+ */
+#define DEFAULT_INTERVAL_MS 100
+
+/**
+ * @brief Default ring size in MB
+ */
+#define DEFAULT_LOG_MB 64
+
+/**
+ * @brief Number of counters kept per sample
+ */
+#define NUM_COUNTERS 7
+
+/**
+ * @brief Largest encoded sample: timestamp, change mask and every counter
+ */
+#define MAX_SAMPLE_BYTES (10 + 1 + NUM_COUNTERS * 10)
+
+/**
+ * @brief Gap, in sample intervals, after which two samples are not differenced
+ */
+#define GAP_INTERVALS 5
+
+/**
+ * @brief One disk sample
+ */
+typedef struct {
+    uint64_t timeUs;                 /**< Wall clock time in microseconds */
+    uint64_t c[NUM_COUNTERS];        /**< Counters, see CounterIndex */
+} Sample;
+
+/**
+ * @brief Meaning of the entries of Sample::c, in /proc/diskstats order
+ */
+typedef enum {
+    C_READ_OPS,      /**< Reads completed */
+    C_READ_SECTORS,  /**< 512-byte sectors read */
+    C_READ_MS,       /**< Milliseconds spent reading */
+    C_WRITE_OPS,     /**< Writes completed */
+    C_WRITE_SECTORS, /**< 512-byte sectors written */
+    C_WRITE_MS,      /**< Milliseconds spent writing */
+    C_IO_MS          /**< Milliseconds the device was busy */
+} CounterIndex;
+
+/**
+ * @brief Header page of a log file
+ */
+typedef struct {
+    char magic[8];           /**< LOG_MAGIC */
+    uint32_t blockSize;      /**< BLOCK_SIZE */
+    uint32_t blockCount;     /**< Blocks in the ring */
+    uint32_t intervalMs;     /**< Sample interval */
+    uint32_t reserved;       /**< Zero */
+    char device[32];         /**< Device name as in /proc/diskstats */
+} LogHeader;
+
+/**
+ * @brief Header at the start of every ring block
+ *
+ * seq acts as a seqlock: it is cleared before a slot is reused and set once
+ * the slot is empty again. A reader copies the payload, then re-reads seq and
+ * drops the copy if the slot was reused meanwhile.
+ */
+typedef struct {
+    uint64_t seq;            /**< Block sequence number, 0 for unused */
+    uint32_t used;           /**< Payload bytes in use */
+    uint32_t count;          /**< Samples in the block */
+} BlockHeader;
+
+/**
+ * @brief Usable payload bytes per block
+ */
+#define BLOCK_PAYLOAD (BLOCK_SIZE - (int)sizeof(BlockHeader))
+
+/**
+ * @brief Encoder or decoder position inside a block
+ */
+typedef struct {
+    Sample prev;             /**< Previous sample */
+    int64_t prevStepUs;      /**< Previous timestamp delta */
+    uint32_t count;          /**< Samples so far */
+} CodecState;
+
+/**
+ * @brief An open log file
+ */
+typedef struct {
+    int fd;                  /**< Log file */
+    uint8_t* map;            /**< Mapping of the whole file */
+    size_t mapSize;          /**< Size of the mapping */
+    LogHeader* header;       /**< Header page inside the mapping */
+} LogFile;
+
+/**
+ * @brief Writer state
+ */
+typedef struct {
+    LogFile log;             /**< Target log */
+    uint64_t nextSeq;        /**< Sequence number of the next block */
+    BlockHeader* block;      /**< Block being filled, inside the mapping */
+    CodecState codec;        /**< Encoder state of the open block */
+    uint64_t samples;        /**< Samples written */
+    uint64_t bytes;          /**< Payload bytes written */
+} LogWriter;
+
+/**
+ * @brief Set by the signal handler to stop recording
+ */
+static volatile sig_atomic_t stopRequested = 0;
+
+/**
+ * @brief Requests a clean stop
+ * @param sig Signal number
+ */
+static void on_signal(int sig) {
+    (void)sig;
+    stopRequested = 1;
+}
+
+/**
+ * @brief Returns a clock in nanoseconds
+ * @param clock Clock id
+ * @return Current time in nanoseconds
+ */
+static uint64_t clock_ns(clockid_t clock) {
+    struct timespec ts;
+    clock_gettime(clock, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+/* ---------------------------------------------------------------------- */
+/* Encoding                                                                */
+/* ---------------------------------------------------------------------- */
+
+/**
+ * @brief Appends an unsigned LEB128 varint
+ * @param p Output position
+ * @param v Value
+ * @return Position after the varint
+ */
+static uint8_t* put_varint(uint8_t* p, uint64_t v) {
+    while (v >= 0x80) {
+        *p++ = (uint8_t)(v | 0x80);
+        v >>= 7;
+    }
+    *p++ = (uint8_t)v;
+    return p;
+}
+
+/**
+ * @brief Reads an unsigned LEB128 varint
+ * @param[in,out] p Input position, advanced past the varint
+ * @param end End of input
+ * @param[out] v Value
+ * @return 1 on success, 0 if the input is truncated
+ */
+static int get_varint(const uint8_t** p, const uint8_t* end, uint64_t* v) {
+    uint64_t result = 0;
+    for (int shift = 0; *p < end && shift < 64; shift += 7) {
+        uint8_t b = *(*p)++;
+        result |= (uint64_t)(b & 0x7f) << shift;
+        if (!(b & 0x80)) {
+            *v = result;
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief Maps a signed value to an unsigned one with small magnitudes first
+ */
+static uint64_t zigzag(int64_t v) {
+    return ((uint64_t)v << 1) ^ (uint64_t)(v >> 63);
+}
+
+/**
+ * @brief Inverse of zigzag()
+ */
+static int64_t unzigzag(uint64_t v) {
+    return (int64_t)(v >> 1) ^ -(int64_t)(v & 1);
+}
+
+/**
+ * @brief Encodes one sample relative to the codec state
+ *
+ * The first sample of a block is stored absolutely. Later samples store the
+ * timestamp as delta-of-delta, then a bit mask of changed counters, then the
+ * delta of each changed counter.
+ *
+ * @param st Codec state, updated
+ * @param s Sample
+ * @param out Output buffer of at least MAX_SAMPLE_BYTES
+ * @return Number of bytes written
+ */
+static size_t encode_sample(CodecState* st, const Sample* s, uint8_t* out) {
+    uint8_t* p = out;
+    if (st->count == 0) {
+        p = put_varint(p, s->timeUs);
+        for (int i = 0; i < NUM_COUNTERS; i++) p = put_varint(p, s->c[i]);
+        st->prevStepUs = 0;
+    } else {
+        int64_t step = (int64_t)(s->timeUs - st->prev.timeUs);
+        p = put_varint(p, zigzag(step - st->prevStepUs));
+        st->prevStepUs = step;
+
+        uint8_t* mask = p++;
+        *mask = 0;
+        for (int i = 0; i < NUM_COUNTERS; i++) {
+            if (s->c[i] == st->prev.c[i]) continue;
+            *mask |= (uint8_t)(1u << i);
+            p = put_varint(p, zigzag((int64_t)(s->c[i] - st->prev.c[i])));
+        }
+    }
+    st->prev = *s;
+    st->count++;
+    return (size_t)(p - out);
+}
+
+/**
+ * @brief Decodes one sample, the inverse of encode_sample()
+ * @param st Codec state, updated
+ * @param[in,out] p Input position
+ * @param end End of input
+ * @param[out] s Sample
+ * @return 1 on success, 0 on truncated input
+ */
+static int decode_sample(CodecState* st, const uint8_t** p, const uint8_t* end, Sample* s) {
+    uint64_t v;
+    if (st->count == 0) {
+        if (!get_varint(p, end, &s->timeUs)) return 0;
+        for (int i = 0; i < NUM_COUNTERS; i++) {
+            if (!get_varint(p, end, &s->c[i])) return 0;
+        }
+        st->prevStepUs = 0;
+    } else {
+        if (!get_varint(p, end, &v)) return 0;
+        int64_t step = st->prevStepUs + unzigzag(v);
+        st->prevStepUs = step;
+        s->timeUs = st->prev.timeUs + (uint64_t)step;
+
+        if (*p >= end) return 0;
+        uint8_t mask = *(*p)++;
+        for (int i = 0; i < NUM_COUNTERS; i++) {
+            s->c[i] = st->prev.c[i];
+            if (!(mask & (1u << i))) continue;
+            if (!get_varint(p, end, &v)) return 0;
+            s->c[i] += (uint64_t)unzigzag(v);
+        }
+    }
+    st->prev = *s;
+    st->count++;
+    return 1;
+}
+
+/* ---------------------------------------------------------------------- */
+/* Log file                                                                */
+/* ---------------------------------------------------------------------- */
+
+/**
+ * @brief Returns a pointer to a ring block
+ * @param log Log file
+ * @param index Block index
+ * @return Start of the block
+ */
+static uint8_t* block_at(const LogFile* log, uint32_t index) {
+    return log->map + BLOCK_SIZE + (size_t)index * BLOCK_SIZE;
+}
+
+/**
+ * @brief Opens and maps a log file, creating it if requested
+ * @param log Log to fill in
+ * @param path File path
+ * @param create Create or reuse a log for writing
+ * @param blockCount Ring size when creating
+ * @param intervalMs Sample interval when creating
+ * @param device Device name when creating
+ * @return 1 on success, 0 on failure
+ */
+static int log_open(LogFile* log, const char* path, int create, uint32_t blockCount,
+                    uint32_t intervalMs, const char* device) {
+    memset(log, 0, sizeof(*log));
+    log->fd = open(path, create ? (O_RDWR | O_CREAT) : O_RDONLY, 0644);
+    if (log->fd < 0) {
+        printf("Error opening %s: %s\n", path, strerror(errno));
+        return 0;
+    }
+
+    struct stat st;
+    fstat(log->fd, &st);
+    LogHeader existing;
+    int valid = st.st_size >= BLOCK_SIZE &&
+                pread(log->fd, &existing, sizeof(existing), 0) == (ssize_t)sizeof(existing) &&
+                memcmp(existing.magic, LOG_MAGIC, 8) == 0 && existing.blockSize == BLOCK_SIZE &&
+                (uint64_t)st.st_size >= (uint64_t)BLOCK_SIZE * (existing.blockCount + 1);
+
+    if (!create && !valid) {
+        printf("Error: %s is not a disk sample log\n", path);
+        close(log->fd);
+        return 0;
+    }
+    if (create && valid && (strcmp(existing.device, device) != 0 ||
+                            existing.intervalMs != intervalMs)) {
+        printf("Error: %s was recorded for %s at %u ms; refusing to mix samples\n",
+               path, existing.device, existing.intervalMs);
+        close(log->fd);
+        return 0;
+    }
+    if (create && !valid) {
+        // Fresh log: size it up front so the mapping never grows
+        if (ftruncate(log->fd, 0) != 0 ||
+            ftruncate(log->fd, (off_t)BLOCK_SIZE * (blockCount + 1)) != 0) {
+            printf("Error sizing %s: %s\n", path, strerror(errno));
+            close(log->fd);
+            return 0;
+        }
+    }
+    if (valid) blockCount = existing.blockCount;
+
+    log->mapSize = (size_t)BLOCK_SIZE * (blockCount + 1);
+    log->map = (uint8_t*)mmap(NULL, log->mapSize, create ? (PROT_READ | PROT_WRITE) : PROT_READ,
+                              MAP_SHARED, log->fd, 0);
+    if (log->map == MAP_FAILED) {
+        printf("Error mapping %s: %s\n", path, strerror(errno));
+        close(log->fd);
+        return 0;
+    }
+    log->header = (LogHeader*)log->map;
+
+    if (create && !valid) {
+        LogHeader* h = log->header;
+        h->blockSize = BLOCK_SIZE;
+        h->blockCount = blockCount;
+        h->intervalMs = intervalMs;
+        snprintf(h->device, sizeof(h->device), "%s", device);
+        memcpy(h->magic, LOG_MAGIC, 8);
+    }
+    if (!create) madvise(log->map, log->mapSize, MADV_SEQUENTIAL);
+    return 1;
+}
+
+/**
+ * @brief Unmaps and closes a log file
+ * @param log Log to close
+ */
+static void log_close(LogFile* log) {
+    munmap(log->map, log->mapSize);
+    close(log->fd);
+}
+
+/**
+ * @brief A used block and the sequence number it had when listed
+ */
+typedef struct {
+    uint64_t seq;            /**< Sequence number at listing time */
+    uint32_t index;          /**< Block index */
+} BlockRef;
+
+/**
+ * @brief Compares block references by sequence number, for qsort
+ */
+static int compare_block_seq(const void* a, const void* b) {
+    uint64_t x = ((const BlockRef*)a)->seq, y = ((const BlockRef*)b)->seq;
+    return (x > y) - (x < y);
+}
+
+/**
+ * @brief Lists the used blocks of a log in write order
+ *
+ * Sequence numbers are snapshotted first, so a writer reusing a slot during
+ * the sort cannot make the comparison inconsistent.
+ *
+ * @param log Log file
+ * @param[out] order Block references, caller frees
+ * @return Number of used blocks
+ */
+static uint32_t log_block_order(const LogFile* log, BlockRef** order) {
+    uint32_t n = 0;
+    *order = (BlockRef*)malloc(sizeof(BlockRef) * (log->header->blockCount + 1));
+    if (!*order) {
+        printf("Error: Could not allocate block list\n");
+        exit(1);
+    }
+    for (uint32_t i = 0; i < log->header->blockCount; i++) {
+        const BlockHeader* bh = (const BlockHeader*)block_at(log, i);
+        uint64_t seq = __atomic_load_n(&bh->seq, __ATOMIC_ACQUIRE);
+        if (seq == 0) continue;
+        (*order)[n].seq = seq;
+        (*order)[n].index = i;
+        n++;
+    }
+    qsort(*order, n, sizeof(BlockRef), compare_block_seq);
+    return n;
+}
+
+/* ---------------------------------------------------------------------- */
+/* Writer                                                                  */
+/* ---------------------------------------------------------------------- */
+
+/**
+ * @brief Starts a new block in the next ring slot
+ *
+ * The slot is retired (seq cleared) before it is emptied and gets its new
+ * seq only once it is empty, so the old samples are never read under the new
+ * sequence number.
+ *
+ * @param w Writer
+ */
+static void writer_new_block(LogWriter* w) {
+    uint64_t seq = w->nextSeq++;
+    BlockHeader* bh = (BlockHeader*)block_at(&w->log, (uint32_t)(seq % w->log.header->blockCount));
+    __atomic_store_n(&bh->seq, 0, __ATOMIC_RELAXED);
+    // Order the retirement before any store that empties or refills the slot
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    __atomic_store_n(&bh->used, 0, __ATOMIC_RELEASE);
+    bh->count = 0;
+    __atomic_store_n(&bh->seq, seq, __ATOMIC_RELEASE);
+    w->block = bh;
+    memset(&w->codec, 0, sizeof(w->codec));
+}
+
+/**
+ * @brief Prepares a writer, continuing after the newest block of an existing log
+ * @param w Writer
+ * @return 1 on success
+ */
+static int writer_init(LogWriter* w) {
+    BlockRef* order;
+    uint32_t n = log_block_order(&w->log, &order);
+    w->nextSeq = 1;
+    if (n > 0) w->nextSeq = order[n - 1].seq + 1;
+    free(order);
+    writer_new_block(w);
+    return 1;
+}
+
+/**
+ * @brief Appends one sample; costs no system call
+ *
+ * The sample is encoded past the end of the payload and only then made
+ * visible by advancing used, so a reader never sees a partial sample.
+ *
+ * @param w Writer
+ * @param s Sample
+ */
+static void writer_append(LogWriter* w, const Sample* s) {
+    BlockHeader* bh = w->block;
+    if (bh->used + MAX_SAMPLE_BYTES > BLOCK_PAYLOAD) {
+        writer_new_block(w);
+        bh = w->block;
+    }
+    size_t n = encode_sample(&w->codec, s, (uint8_t*)bh + sizeof(BlockHeader) + bh->used);
+    bh->count++;
+    __atomic_store_n(&bh->used, bh->used + (uint32_t)n, __ATOMIC_RELEASE);
+    w->samples++;
+    w->bytes += n;
+}
+
+/* ---------------------------------------------------------------------- */
+/* Recording                                                               */
+/* ---------------------------------------------------------------------- */
+
+/**
+ * @brief Reads one device's counters from an open /proc/diskstats
+ * @param fd Open /proc/diskstats
+ * @param device Device name
+ * @param[out] s Sample, counters only
+ * @return 1 if the device was found
+ */
+static int read_device(int fd, const char* device, Sample* s) {
+    static char buf[65536];
+    ssize_t n = pread(fd, buf, sizeof(buf) - 1, 0);
+    if (n <= 0) return 0;
+    buf[n] = '\0';
+
+    size_t len = strlen(device);
+    for (char* line = buf; line && *line; ) {
+        char* next = strchr(line, '\n');
+        if (next) *next++ = '\0';
+
+        unsigned maj, min;
+        int nameStart, nameEnd;
+        if (sscanf(line, "%u %u %n%*s%n", &maj, &min, &nameStart, &nameEnd) == 2 &&
+            (size_t)(nameEnd - nameStart) == len && memcmp(line + nameStart, device, len) == 0) {
+            unsigned long long v[11];
+            if (sscanf(line + nameEnd, "%llu %llu %llu %llu %llu %llu %llu %llu %llu %llu",
+                       &v[0], &v[1], &v[2], &v[3], &v[4], &v[5], &v[6], &v[7], &v[8], &v[9]) != 10) {
+                return 0;
+            }
+            s->c[C_READ_OPS] = v[0];
+            s->c[C_READ_SECTORS] = v[2];
+            s->c[C_READ_MS] = v[3];
+            s->c[C_WRITE_OPS] = v[4];
+            s->c[C_WRITE_SECTORS] = v[6];
+            s->c[C_WRITE_MS] = v[7];
+            s->c[C_IO_MS] = v[9];
+            return 1;
+        }
+        line = next;
+    }
+    return 0;
+}
+
+/**
+ * @brief Samples a device at a fixed interval into the log
+ * @param w Writer
+ * @param durationSec Stop after this many seconds, 0 to run until signalled
+ * @return 0 on success, 1 on failure
+ */
+static int record(LogWriter* w, int durationSec) {
+    const LogHeader* h = w->log.header;
+    int statsFd = open("/proc/diskstats", O_RDONLY | O_CLOEXEC);
+    if (statsFd < 0) {
+        printf("Error opening /proc/diskstats: %s\n", strerror(errno));
+        return 1;
+    }
+
+    uint64_t intervalNs = (uint64_t)h->intervalMs * 1000000ull;
+    uint64_t next = clock_ns(CLOCK_MONOTONIC);
+    uint64_t end = durationSec > 0 ? next + (uint64_t)durationSec * 1000000000ull : UINT64_MAX;
+    uint64_t encodeNs = 0;
+    uint64_t missed = 0;
+
+    while (!stopRequested && next < end) {
+        Sample s;
+        // Stamp with the time the counters were actually read; scheduling
+        // jitter only costs a few bits of delta-of-delta
+        s.timeUs = clock_ns(CLOCK_REALTIME) / 1000;
+        if (!read_device(statsFd, h->device, &s)) {
+            printf("Error: device %s not found in /proc/diskstats\n", h->device);
+            close(statsFd);
+            return 1;
+        }
+
+        uint64_t t0 = clock_ns(CLOCK_MONOTONIC);
+        writer_append(w, &s);
+        encodeNs += clock_ns(CLOCK_MONOTONIC) - t0;
+
+        next += intervalNs;
+        uint64_t now = clock_ns(CLOCK_MONOTONIC);
+        if (next <= now) {
+            // Overran: skip the missed ticks instead of sampling back to back,
+            // so the gap stays visible to the reader
+            uint64_t skip = (now - next) / intervalNs + 1;
+            next += skip * intervalNs;
+            missed += skip;
+        }
+        struct timespec ts = { (time_t)(next / 1000000000ull), (long)(next % 1000000000ull) };
+        while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR && !stopRequested) {
+        }
+    }
+    close(statsFd);
+
+    printf("Samples written: %llu\n", (unsigned long long)w->samples);
+    if (missed > 0) printf("Intervals missed: %llu\n", (unsigned long long)missed);
+    if (w->samples > 0) {
+        double perSample = (double)w->bytes / w->samples;
+        double perDay = perSample * 86400000.0 / h->intervalMs;
+        printf("Average encoded size: %.2f bytes/sample (%.2f MB/day at %u ms)\n",
+               perSample, perDay / (1024.0 * 1024.0), h->intervalMs);
+        printf("Average logging cost: %.0f ns/sample\n", (double)encodeNs / w->samples);
+        printf("Ring capacity at this rate: %.1f days\n",
+               (double)h->blockCount * BLOCK_PAYLOAD / perDay);
+    }
+    return 0;
+}
+
+/* ---------------------------------------------------------------------- */
+/* Reading                                                                 */
+/* ---------------------------------------------------------------------- */
+
+/**
+ * @brief Callback invoked for every decoded sample in time order
+ */
+typedef void (*SampleFn)(const Sample* s, void* ctx);
+
+/**
+ * @brief Decodes every sample of a log in write order
+ *
+ * Safe against a concurrent recorder: each block is copied, then its seq is
+ * checked again, and a block reused during the copy is skipped.
+ *
+ * @param log Log file
+ * @param fn Callback
+ * @param ctx Callback context
+ * @return Number of samples decoded
+ */
+static uint64_t log_for_each(const LogFile* log, SampleFn fn, void* ctx) {
+    BlockRef* order;
+    uint32_t n = log_block_order(log, &order);
+    uint64_t total = 0;
+    uint8_t copy[BLOCK_PAYLOAD];
+
+    for (uint32_t b = 0; b < n; b++) {
+        const uint8_t* block = block_at(log, order[b].index);
+        const BlockHeader* bh = (const BlockHeader*)block;
+        if (__atomic_load_n(&bh->seq, __ATOMIC_ACQUIRE) != order[b].seq) continue;
+        uint32_t used = __atomic_load_n(&bh->used, __ATOMIC_ACQUIRE);
+        if (used > BLOCK_PAYLOAD) continue;
+        memcpy(copy, block + sizeof(BlockHeader), used);
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if (__atomic_load_n(&bh->seq, __ATOMIC_RELAXED) != order[b].seq) continue;
+
+        const uint8_t* p = copy;
+        const uint8_t* end = p + used;
+        CodecState st;
+        memset(&st, 0, sizeof(st));
+        Sample s;
+        while (p < end && decode_sample(&st, &p, end, &s)) {
+            fn(&s, ctx);
+            total++;
+        }
+    }
+    free(order);
+    return total;
+}
+
+/**
+ * @brief Growable array of doubles
+ */
+typedef struct {
+    double* v;               /**< Values */
+    size_t n;                /**< Used entries */
+    size_t cap;              /**< Allocated entries */
+} Series;
+
+/**
+ * @brief Appends to a series
+ * @param s Series
+ * @param x Value
+ */
+static void series_push(Series* s, double x) {
+    if (s->n == s->cap) {
+        s->cap = s->cap ? s->cap * 2 : 4096;
+        s->v = (double*)realloc(s->v, s->cap * sizeof(double));
+        if (!s->v) {
+            printf("Error: Could not allocate sample series\n");
+            exit(1);
+        }
+    }
+    s->v[s->n++] = x;
+}
+
+/**
+ * @brief Compares two doubles for qsort
+ */
+static int compare_double(const void* a, const void* b) {
+    double x = *(const double*)a, y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+/**
+ * @brief Returns a percentile of a sorted series
+ * @param s Sorted series
+ * @param pct Percentile in [0, 100]
+ * @return Value at the percentile, 0 for an empty series
+ */
+static double series_percentile(const Series* s, double pct) {
+    if (s->n == 0) return 0;
+    size_t idx = (size_t)(pct / 100.0 * (s->n - 1) + 0.5);
+    return s->v[idx];
+}
+
+/**
+ * @brief Accumulated state while walking a log
+ */
+typedef struct {
+    uint32_t intervalMs;     /**< Nominal sample interval */
+    int havePrev;            /**< Whether prev holds a sample */
+    Sample prev;             /**< Previous sample */
+    Sample first;            /**< First sample of the log */
+    uint64_t sum[NUM_COUNTERS]; /**< Counter increases over valid intervals */
+    uint64_t gaps;           /**< Intervals skipped as gaps or resets */
+    Series readIops;         /**< Per-interval read IOPS */
+    Series writeIops;        /**< Per-interval write IOPS */
+    Series readMBps;         /**< Per-interval read MB/s */
+    Series writeMBps;        /**< Per-interval write MB/s */
+    Series util;             /**< Per-interval busy percentage */
+
+    /* Replay only */
+    double windowSec;        /**< Replay aggregation window */
+    double speed;            /**< Replay speed factor, 0 for as fast as possible */
+    uint64_t windowStartUs;  /**< Start of the current window */
+    uint64_t window[NUM_COUNTERS]; /**< Counter increases in the current window */
+    uint64_t replayStartUs;  /**< Log time at which replay started */
+    uint64_t wallStartNs;    /**< Wall time at which replay started */
+} Walk;
+
+/**
+ * @brief Computes counter increases between two samples
+ * @param w Walk state
+ * @param s Current sample
+ * @param[out] d Counter increases
+ * @param[out] dt Interval in seconds
+ * @return 1 if the interval is valid, 0 for a gap or counter reset
+ */
+static int walk_delta(Walk* w, const Sample* s, uint64_t* d, double* dt) {
+    if (!w->havePrev) {
+        w->first = *s;
+        w->prev = *s;
+        w->havePrev = 1;
+        return 0;
+    }
+    int valid = s->timeUs > w->prev.timeUs &&
+                s->timeUs - w->prev.timeUs <= (uint64_t)w->intervalMs * 1000 * GAP_INTERVALS;
+    for (int i = 0; valid && i < NUM_COUNTERS; i++) {
+        if (s->c[i] < w->prev.c[i]) valid = 0;
+        else d[i] = s->c[i] - w->prev.c[i];
+    }
+    *dt = (s->timeUs - w->prev.timeUs) / 1e6;
+    w->prev = *s;
+    if (!valid) w->gaps++;
+    return valid;
+}
+
+/**
+ * @brief Summary callback: accumulates totals and per-interval rates
+ * @param s Sample
+ * @param ctx Walk state
+ */
+static void summarize_sample(const Sample* s, void* ctx) {
+    Walk* w = (Walk*)ctx;
+    uint64_t d[NUM_COUNTERS];
+    double dt;
+    if (!walk_delta(w, s, d, &dt)) return;
+
+    for (int i = 0; i < NUM_COUNTERS; i++) w->sum[i] += d[i];
+    series_push(&w->readIops, d[C_READ_OPS] / dt);
+    series_push(&w->writeIops, d[C_WRITE_OPS] / dt);
+    series_push(&w->readMBps, d[C_READ_SECTORS] * 512.0 / (1024.0 * 1024.0) / dt);
+    series_push(&w->writeMBps, d[C_WRITE_SECTORS] * 512.0 / (1024.0 * 1024.0) / dt);
+    series_push(&w->util, d[C_IO_MS] / 10.0 / dt);
+}
+
+/**
+ * @brief Prints read/write totals and ratios in the layout of readWriteCompare.c
+ * @param sum Counter increases
+ */
+static void print_ratios(const uint64_t* sum) {
+    uint64_t readOps = sum[C_READ_OPS];
+    uint64_t writeOps = sum[C_WRITE_OPS];
+    uint64_t readBytes = sum[C_READ_SECTORS] * 512ull;
+    uint64_t writeBytes = sum[C_WRITE_SECTORS] * 512ull;
+    double opRatio = (writeOps > 0) ? ((double)readOps / writeOps) : 0;
+    double bytesRatio = (writeBytes > 0) ? ((double)readBytes / writeBytes) : 0;
+
+    printf("Read operations:  %llu\n", (unsigned long long)readOps);
+    printf("Write operations: %llu\n", (unsigned long long)writeOps);
+    printf("Read/Write ratio: %.2f:1\n\n", opRatio);
+
+    printf("Bytes read:       %llu bytes (%.2f MB)\n", (unsigned long long)readBytes,
+           readBytes / (1024.0 * 1024.0));
+    printf("Bytes written:    %llu bytes (%.2f MB)\n", (unsigned long long)writeBytes,
+           writeBytes / (1024.0 * 1024.0));
+    printf("Bytes ratio:      %.2f:1\n\n", bytesRatio);
+
+    if (readOps > 0 && writeOps > 0) {
+        printf("For every 10,000 read operations, there are approximately %.0f write operations\n\n",
+               10000.0 * writeOps / readOps);
+    }
+}
+
+/**
+ * @brief Prints percentiles of one per-interval series
+ * @param name Series name
+ * @param s Series, sorted in place
+ */
+static void print_series(const char* name, Series* s) {
+    qsort(s->v, s->n, sizeof(double), compare_double);
+    printf("  %-12s p50 %10.2f  p90 %10.2f  p99 %10.2f  max %10.2f\n", name,
+           series_percentile(s, 50), series_percentile(s, 90),
+           series_percentile(s, 99), series_percentile(s, 100));
+}
+
+/**
+ * @brief Prints a summary of the whole log
+ * @param log Log file
+ * @return 0 on success
+ */
+static int summarize(const LogFile* log) {
+    Walk w;
+    memset(&w, 0, sizeof(w));
+    w.intervalMs = log->header->intervalMs;
+
+    uint64_t t0 = clock_ns(CLOCK_MONOTONIC);
+    uint64_t samples = log_for_each(log, summarize_sample, &w);
+    double decodeSec = (clock_ns(CLOCK_MONOTONIC) - t0) / 1e9;
+
+    if (samples < 2) {
+        printf("Log holds %llu samples; nothing to summarize\n", (unsigned long long)samples);
+        return 0;
+    }
+    double spanSec = (w.prev.timeUs - w.first.timeUs) / 1e6;
+    time_t from = (time_t)(w.first.timeUs / 1000000), to = (time_t)(w.prev.timeUs / 1000000);
+    char fromText[32], toText[32];
+    strftime(fromText, sizeof(fromText), "%Y-%m-%d %H:%M:%S", localtime(&from));
+    strftime(toText, sizeof(toText), "%Y-%m-%d %H:%M:%S", localtime(&to));
+
+    printf("Device %s, %u ms samples\n", log->header->device, log->header->intervalMs);
+    printf("From %s to %s (%.1f hours, %llu samples, %llu gaps)\n",
+           fromText, toText, spanSec / 3600.0, (unsigned long long)samples,
+           (unsigned long long)w.gaps);
+    printf("Decoded in %.3f s (%.0fx real time)\n\n", decodeSec,
+           decodeSec > 0 ? spanSec / decodeSec : 0);
+
+    printf("Results:\n");
+    printf("--------\n");
+    print_ratios(w.sum);
+
+    printf("Per-interval rates:\n");
+    print_series("read IOPS", &w.readIops);
+    print_series("write IOPS", &w.writeIops);
+    print_series("read MB/s", &w.readMBps);
+    print_series("write MB/s", &w.writeMBps);
+    print_series("busy %", &w.util);
+
+    free(w.readIops.v);
+    free(w.writeIops.v);
+    free(w.readMBps.v);
+    free(w.writeMBps.v);
+    free(w.util.v);
+    return 0;
+}
+
+/**
+ * @brief Prints one replay window and paces output to the replay speed
+ * @param w Walk state
+ * @param endUs End of the window in log time
+ */
+static void replay_emit(Walk* w, uint64_t endUs) {
+    double dt = (endUs - w->windowStartUs) / 1e6;
+    if (dt <= 0) return;
+
+    if (w->speed > 0) {
+        uint64_t due = w->wallStartNs +
+                       (uint64_t)((endUs - w->replayStartUs) * 1000.0 / w->speed);
+        struct timespec ts = { (time_t)(due / 1000000000ull), (long)(due % 1000000000ull) };
+        clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL);
+    }
+
+    time_t t = (time_t)(endUs / 1000000);
+    char text[16];
+    strftime(text, sizeof(text), "%H:%M:%S", localtime(&t));
+    uint64_t r = w->window[C_READ_OPS], wr = w->window[C_WRITE_OPS];
+    printf("%s.%03u  %10.0f %10.0f %10.2f %10.2f %8.2f\n", text, (unsigned)(endUs / 1000 % 1000),
+           r / dt, wr / dt,
+           w->window[C_READ_SECTORS] * 512.0 / (1024.0 * 1024.0) / dt,
+           w->window[C_WRITE_SECTORS] * 512.0 / (1024.0 * 1024.0) / dt,
+           wr ? (double)r / wr : 0);
+    memset(w->window, 0, sizeof(w->window));
+    w->windowStartUs = endUs;
+}
+
+/**
+ * @brief Replay callback: aggregates samples into windows and prints them
+ * @param s Sample
+ * @param ctx Walk state
+ */
+static void replay_sample(const Sample* s, void* ctx) {
+    Walk* w = (Walk*)ctx;
+    uint64_t d[NUM_COUNTERS];
+    double dt;
+    int valid = walk_delta(w, s, d, &dt);
+    if (w->windowStartUs == 0 || !valid) {
+        // Start or restart after a gap
+        w->windowStartUs = s->timeUs;
+        if (w->replayStartUs == 0) w->replayStartUs = s->timeUs;
+        memset(w->window, 0, sizeof(w->window));
+        return;
+    }
+    for (int i = 0; i < NUM_COUNTERS; i++) w->window[i] += d[i];
+    if (s->timeUs - w->windowStartUs >= (uint64_t)(w->windowSec * 1e6)) replay_emit(w, s->timeUs);
+}
+
+/**
+ * @brief Replays the log as per-window rates
+ * @param log Log file
+ * @param windowSec Aggregation window
+ * @param speed Speed factor relative to real time, 0 for as fast as possible
+ * @return 0 on success
+ */
+static int replay(const LogFile* log, double windowSec, double speed) {
+    Walk w;
+    memset(&w, 0, sizeof(w));
+    w.intervalMs = log->header->intervalMs;
+    w.windowSec = windowSec;
+    w.speed = speed;
+    w.wallStartNs = clock_ns(CLOCK_MONOTONIC);
+
+    printf("%-12s  %10s %10s %10s %10s %8s\n",
+           "TIME", "RD IOPS", "WR IOPS", "RD MB/s", "WR MB/s", "R/W");
+    log_for_each(log, replay_sample, &w);
+    return 0;
+}
+
+/**
+ * @brief Prints command line usage
+ * @param prog Program name
+ */
+static void usage(const char* prog) {
+    printf("Usage:\n");
+    printf("  %s record -f log -d device [-i interval_ms] [-s size_mb] [-t seconds]\n", prog);
+    printf("  %s summarize -f log\n", prog);
+    printf("  %s replay -f log [-w window_sec] [-x speed]\n", prog);
+    printf("Defaults: %d ms interval, %d MB ring, replay 1 s windows as fast as possible\n",
+           DEFAULT_INTERVAL_MS, DEFAULT_LOG_MB);
+}
+
+/**
+ * @brief Main program entry point
+ * @return 0 on success, 1 on failure
+ */
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        usage(argv[0]);
+        return 1;
+    }
+    const char* mode = argv[1];
+    const char* path = NULL;
+    const char* device = NULL;
+    int intervalMs = DEFAULT_INTERVAL_MS;
+    int sizeMb = DEFAULT_LOG_MB;
+    int durationSec = 0;
+    double windowSec = 1.0;
+    double speed = 0;
+
+    int opt;
+    optind = 2;
+    while ((opt = getopt(argc, argv, "f:d:i:s:t:w:x:h")) != -1) {
+        switch (opt) {
+        case 'f': path = optarg; break;
+        case 'd': device = optarg; break;
+        case 'i': intervalMs = atoi(optarg); break;
+        case 's': sizeMb = atoi(optarg); break;
+        case 't': durationSec = atoi(optarg); break;
+        case 'w': windowSec = atof(optarg); break;
+        case 'x': speed = atof(optarg); break;
+        default:
+            usage(argv[0]);
+            return opt == 'h' ? 0 : 1;
+        }
+    }
+    if (!path) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    if (strcmp(mode, "record") == 0) {
+        if (!device || intervalMs <= 0 || sizeMb <= 0 ||
+            strlen(device) >= sizeof(((LogHeader*)0)->device)) {
+            usage(argv[0]);
+            return 1;
+        }
+        static LogWriter w;
+        uint32_t blocks = (uint32_t)((uint64_t)sizeMb * 1024 * 1024 / BLOCK_SIZE);
+        if (!log_open(&w.log, path, 1, blocks, (uint32_t)intervalMs, device)) return 1;
+        writer_init(&w);
+
+        signal(SIGINT, on_signal);
+        signal(SIGTERM, on_signal);
+        printf("Recording %s every %d ms into %s (%u blocks); Ctrl+C to stop\n",
+               device, intervalMs, path, w.log.header->blockCount);
+        int rc = record(&w, durationSec);
+        log_close(&w.log);
+        return rc;
+    }
+
+    LogFile log;
+    if (strcmp(mode, "summarize") == 0) {
+        if (!log_open(&log, path, 0, 0, 0, NULL)) return 1;
+        int rc = summarize(&log);
+        log_close(&log);
+        return rc;
+    }
+    if (strcmp(mode, "replay") == 0) {
+        if (windowSec <= 0 || speed < 0) {
+            usage(argv[0]);
+            return 1;
+        }
+        if (!log_open(&log, path, 0, 0, 0, NULL)) return 1;
+        int rc = replay(&log, windowSec, speed);
+        log_close(&log);
+        return rc;
+    }
+    usage(argv[0]);
+    return 1;
+}
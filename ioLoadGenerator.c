@@ -0,0 +1,877 @@
+/**
+ * @file ioLoadGenerator.c
+ * @brief Linux synthetic I/O load generator with a configurable read/write mix
+ *
+ * Issues block I/O against a test file with a known read:write ratio so the
+ * ratios reported by the disk monitors can be checked and disks can be
+ * characterized. Requests go through io_uring when the kernel offers it and
+ * fall back to a pool of threads issuing pread/pwrite otherwise. At the end
+ * the configured ratio is compared with the ratio measured on the backing
+ * device through /proc/diskstats.
+ */
+
+#define _GNU_SOURCE
+#include <errno.h>
+#include <fcntl.h>
+#include <getopt.h>
+#include <linux/io_uring.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <sys/sysmacros.h>
+#include <time.h>
+#include <unistd.h>
+
+/**
+ * @brief Default test file size in MB
+ */
+#define DEFAULT_FILE_MB 1024
+
+/**
+ * @brief Default block size in bytes
+ */
+#define DEFAULT_BLOCK_SIZE 4096
+
+/**
+ * @brief Default number of requests in flight
+ */
+#define DEFAULT_QUEUE_DEPTH 16
+
+/**
+ * @brief Default run time in seconds
+ */
+#define DEFAULT_DURATION_SEC 30
+
+/**
+ * @brief Default tolerance between configured and measured read share, in percentage points
+ */
+#define DEFAULT_TOLERANCE_PCT 5.0
+
+/**
+ * @brief Alignment of I/O buffers, sufficient for O_DIRECT on common devices
+ */
+#define BUFFER_ALIGN 4096
+
+/**
+ * @brief Chunk size used while pre-filling the test file
+ */
+#define FILL_CHUNK (1024 * 1024)
+
+/**
+ * @brief Sub-buckets per power of two in the latency histogram
+ */
+#define HIST_SUB_BITS 4
+
+/**
+ * @brief Number of latency histogram buckets (covers up to ~2^40 ns)
+ */
+#define HIST_BUCKETS (40 << HIST_SUB_BITS)
+
+/**
+ * @brief I/O engine used to issue requests
+ */
+typedef enum {
+    ENGINE_AUTO,     /**< io_uring if available, else threads */
+    ENGINE_URING,    /**< io_uring only */
+    ENGINE_THREADS   /**< Thread pool with pread/pwrite */
+} Engine;
+
+/**
+ * @brief Workload parameters
+ */
+typedef struct {
+    const char* path;        /**< Test file */
+    uint64_t fileSize;       /**< Test file size in bytes */
+    uint32_t blockSize;      /**< Request size in bytes */
+    int queueDepth;          /**< Requests in flight */
+    int readWeight;          /**< Read part of the read:write ratio */
+    int writeWeight;         /**< Write part of the read:write ratio */
+    int random;              /**< Random offsets instead of sequential */
+    int direct;              /**< Open with O_DIRECT */
+    int durationSec;         /**< Run time */
+    double tolerancePct;     /**< Allowed deviation of the measured read share */
+    Engine engine;           /**< Requested engine */
+} Config;
+
+/**
+ * @brief Log-linear latency histogram in nanoseconds
+ */
+typedef struct {
+    uint64_t counts[HIST_BUCKETS]; /**< Samples per bucket */
+    uint64_t total;                /**< Number of samples */
+    uint64_t max;                  /**< Largest sample */
+} Histogram;
+
+/**
+ * @brief Per-worker results, merged after the run
+ */
+typedef struct {
+    Histogram readLat;       /**< Read latencies */
+    Histogram writeLat;      /**< Write latencies */
+    uint64_t readOps;        /**< Completed reads */
+    uint64_t writeOps;       /**< Completed writes */
+    uint64_t errors;         /**< Failed or short requests */
+} Results;
+
+/**
+ * @brief Device counters from /proc/diskstats
+ */
+typedef struct {
+    uint64_t readOps;        /**< Reads completed */
+    uint64_t writeOps;       /**< Writes completed */
+    uint64_t readBytes;      /**< Bytes read */
+    uint64_t writeBytes;     /**< Bytes written */
+} DiskStats;
+
+/**
+ * @brief State shared between all workers
+ */
+typedef struct {
+    const Config* cfg;       /**< Workload parameters */
+    int fd;                  /**< Test file */
+    uint64_t blocks;         /**< Number of blocks in the test file */
+    uint64_t nextOp;         /**< Next operation index, shared atomically */
+    uint64_t deadlineNs;     /**< Monotonic time at which to stop issuing */
+} Workload;
+
+/**
+ * @brief Returns the monotonic clock in nanoseconds
+ * @return Current time in nanoseconds
+ */
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+/**
+ * @brief Maps a latency to its histogram bucket
+ * @param v Latency in nanoseconds
+ * @return Bucket index
+ */
+static int hist_bucket(uint64_t v) {
+    if (v < (1u << HIST_SUB_BITS)) return (int)v;
+    int msb = 63 - __builtin_clzll(v);
+    int shift = msb - HIST_SUB_BITS;
+    int idx = ((shift + 1) << HIST_SUB_BITS) + (int)((v >> shift) & ((1u << HIST_SUB_BITS) - 1));
+    return idx < HIST_BUCKETS ? idx : HIST_BUCKETS - 1;
+}
+
+/**
+ * @brief Returns the lower bound of a histogram bucket
+ * @param idx Bucket index
+ * @return Smallest latency in nanoseconds mapping to the bucket
+ */
+static uint64_t hist_value(int idx) {
+    if (idx < (1 << HIST_SUB_BITS)) return (uint64_t)idx;
+    int shift = (idx >> HIST_SUB_BITS) - 1;
+    uint64_t sub = (uint64_t)(idx & ((1 << HIST_SUB_BITS) - 1));
+    return ((1ull << HIST_SUB_BITS) | sub) << shift;
+}
+
+/**
+ * @brief Records one latency sample
+ * @param h Histogram
+ * @param v Latency in nanoseconds
+ */
+static void hist_add(Histogram* h, uint64_t v) {
+    h->counts[hist_bucket(v)]++;
+    h->total++;
+    if (v > h->max) h->max = v;
+}
+
+/**
+ * @brief Adds all samples of one histogram to another
+ * @param dst Destination histogram
+ * @param src Source histogram
+ */
+static void hist_merge(Histogram* dst, const Histogram* src) {
+    for (int i = 0; i < HIST_BUCKETS; i++) dst->counts[i] += src->counts[i];
+    dst->total += src->total;
+    if (src->max > dst->max) dst->max = src->max;
+}
+
+/**
+ * @brief Returns the latency at a percentile
+ * @param h Histogram
+ * @param pct Percentile in [0, 100]
+ * @return Latency in nanoseconds
+ */
+static uint64_t hist_percentile(const Histogram* h, double pct) {
+    if (h->total == 0) return 0;
+    uint64_t rank = (uint64_t)(pct / 100.0 * h->total + 0.5);
+    if (rank == 0) rank = 1;
+    uint64_t seen = 0;
+    for (int i = 0; i < HIST_BUCKETS; i++) {
+        seen += h->counts[i];
+        if (seen >= rank) return hist_value(i) < h->max ? hist_value(i) : h->max;
+    }
+    return h->max;
+}
+
+/**
+ * @brief Decides whether an operation is a read
+ *
+ * Spreads reads evenly over the operation sequence so that any window of
+ * operations matches the configured ratio, not just the long-run average.
+ *
+ * @param cfg Workload parameters
+ * @param op Operation index
+ * @return 1 for a read, 0 for a write
+ */
+static int op_is_read(const Config* cfg, uint64_t op) {
+    uint64_t total = (uint64_t)(cfg->readWeight + cfg->writeWeight);
+    uint64_t r = (uint64_t)cfg->readWeight;
+    return ((op + 1) * r) / total > (op * r) / total;
+}
+
+/**
+ * @brief Computes the file offset of an operation
+ * @param w Workload
+ * @param op Operation index
+ * @return Byte offset, aligned to the block size
+ */
+static uint64_t op_offset(const Workload* w, uint64_t op) {
+    uint64_t block;
+    if (w->cfg->random) {
+        // splitmix64 of the op index: stateless, so any worker can compute it
+        uint64_t z = op + 0x9e3779b97f4a7c15ull;
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+        block = (z ^ (z >> 31)) % w->blocks;
+    } else {
+        block = op % w->blocks;
+    }
+    return block * w->cfg->blockSize;
+}
+
+/**
+ * @brief Allocates an aligned I/O buffer filled with a non-zero pattern
+ * @param size Buffer size
+ * @return Buffer, or NULL on failure
+ */
+static void* alloc_buffer(size_t size) {
+    void* buf = NULL;
+    if (posix_memalign(&buf, BUFFER_ALIGN, size) != 0) return NULL;
+    memset(buf, 0xA5, size);
+    return buf;
+}
+
+/* ---------------------------------------------------------------------- */
+/* Thread pool engine                                                      */
+/* ---------------------------------------------------------------------- */
+
+/**
+ * @brief Arguments of one pool thread
+ */
+typedef struct {
+    Workload* w;             /**< Shared workload */
+    Results res;             /**< Results of this thread */
+} PoolThread;
+
+/**
+ * @brief Pool thread body: one synchronous request at a time
+ * @param arg PoolThread
+ * @return NULL
+ */
+static void* pool_worker(void* arg) {
+    PoolThread* t = (PoolThread*)arg;
+    Workload* w = t->w;
+    uint32_t bs = w->cfg->blockSize;
+    void* buf = alloc_buffer(bs);
+    if (!buf) {
+        t->res.errors++;
+        return NULL;
+    }
+
+    while (now_ns() < w->deadlineNs) {
+        uint64_t op = __atomic_fetch_add(&w->nextOp, 1, __ATOMIC_RELAXED);
+        uint64_t off = op_offset(w, op);
+        int isRead = op_is_read(w->cfg, op);
+
+        uint64_t start = now_ns();
+        ssize_t n = isRead ? pread(w->fd, buf, bs, (off_t)off)
+                           : pwrite(w->fd, buf, bs, (off_t)off);
+        uint64_t lat = now_ns() - start;
+
+        if (n != (ssize_t)bs) {
+            t->res.errors++;
+        } else if (isRead) {
+            t->res.readOps++;
+            hist_add(&t->res.readLat, lat);
+        } else {
+            t->res.writeOps++;
+            hist_add(&t->res.writeLat, lat);
+        }
+    }
+    free(buf);
+    return NULL;
+}
+
+/**
+ * @brief Runs the workload on queueDepth threads
+ * @param w Workload
+ * @param[out] res Merged results
+ * @return 1 on success, 0 on failure
+ */
+static int run_threads(Workload* w, Results* res) {
+    int n = w->cfg->queueDepth;
+    PoolThread* threads = (PoolThread*)calloc((size_t)n, sizeof(PoolThread));
+    pthread_t* ids = (pthread_t*)malloc(sizeof(pthread_t) * (size_t)n);
+    if (!threads || !ids) {
+        printf("Error: Could not allocate thread pool\n");
+        free(threads);
+        free(ids);
+        return 0;
+    }
+
+    int started = 0;
+    for (int i = 0; i < n; i++) {
+        threads[i].w = w;
+        if (pthread_create(&ids[i], NULL, pool_worker, &threads[i]) != 0) {
+            printf("Warning: only %d of %d threads started\n", i, n);
+            break;
+        }
+        started++;
+    }
+    for (int i = 0; i < started; i++) {
+        pthread_join(ids[i], NULL);
+        hist_merge(&res->readLat, &threads[i].res.readLat);
+        hist_merge(&res->writeLat, &threads[i].res.writeLat);
+        res->readOps += threads[i].res.readOps;
+        res->writeOps += threads[i].res.writeOps;
+        res->errors += threads[i].res.errors;
+    }
+    free(threads);
+    free(ids);
+    return started > 0;
+}
+
+/* ---------------------------------------------------------------------- */
+/* io_uring engine                                                         */
+/* ---------------------------------------------------------------------- */
+
+/**
+ * @brief Minimal io_uring instance mapped through the raw syscalls
+ */
+typedef struct {
+    int fd;                          /**< Ring file descriptor */
+    unsigned* sqHead;                /**< Submission queue head (kernel) */
+    unsigned* sqTail;                /**< Submission queue tail (us) */
+    unsigned sqMask;                 /**< Submission queue index mask */
+    unsigned* sqArray;               /**< Submission queue index array */
+    struct io_uring_sqe* sqes;       /**< Submission queue entries */
+    unsigned* cqHead;                /**< Completion queue head (us) */
+    unsigned* cqTail;                /**< Completion queue tail (kernel) */
+    unsigned cqMask;                 /**< Completion queue index mask */
+    struct io_uring_cqe* cqes;       /**< Completion queue entries */
+    void* sqMap;                     /**< Mapping of the submission ring */
+    size_t sqMapSize;                /**< Size of sqMap */
+    void* cqMap;                     /**< Mapping of the completion ring */
+    size_t cqMapSize;                /**< Size of cqMap */
+    size_t sqesSize;                 /**< Size of the sqes mapping */
+} Ring;
+
+/**
+ * @brief One request slot of the io_uring engine
+ */
+typedef struct {
+    void* buf;               /**< Request buffer */
+    uint64_t submitNs;       /**< Submission time */
+    int isRead;              /**< Operation type */
+} Slot;
+
+/**
+ * @brief Sets up an io_uring instance
+ * @param ring Ring to initialize
+ * @param entries Submission queue size
+ * @return 1 on success, 0 if io_uring is unavailable
+ */
+static int ring_init(Ring* ring, unsigned entries) {
+    struct io_uring_params p;
+    memset(&p, 0, sizeof(p));
+    memset(ring, 0, sizeof(*ring));
+
+    ring->fd = (int)syscall(__NR_io_uring_setup, entries, &p);
+    if (ring->fd < 0) return 0;
+
+    ring->sqMapSize = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+    ring->cqMapSize = p.cq_off.cqes + p.cq_entries * sizeof(struct io_uring_cqe);
+    int single = (p.features & IORING_FEAT_SINGLE_MMAP) != 0;
+    if (single && ring->cqMapSize > ring->sqMapSize) ring->sqMapSize = ring->cqMapSize;
+
+    ring->sqMap = mmap(NULL, ring->sqMapSize, PROT_READ | PROT_WRITE,
+                       MAP_SHARED | MAP_POPULATE, ring->fd, IORING_OFF_SQ_RING);
+    if (ring->sqMap == MAP_FAILED) goto fail;
+    if (single) {
+        ring->cqMap = ring->sqMap;
+    } else {
+        ring->cqMap = mmap(NULL, ring->cqMapSize, PROT_READ | PROT_WRITE,
+                           MAP_SHARED | MAP_POPULATE, ring->fd, IORING_OFF_CQ_RING);
+        if (ring->cqMap == MAP_FAILED) goto fail;
+    }
+    ring->sqesSize = p.sq_entries * sizeof(struct io_uring_sqe);
+    ring->sqes = (struct io_uring_sqe*)mmap(NULL, ring->sqesSize, PROT_READ | PROT_WRITE,
+                                            MAP_SHARED | MAP_POPULATE, ring->fd, IORING_OFF_SQES);
+    if (ring->sqes == MAP_FAILED) goto fail;
+
+    char* sq = (char*)ring->sqMap;
+    char* cq = (char*)ring->cqMap;
+    ring->sqHead = (unsigned*)(sq + p.sq_off.head);
+    ring->sqTail = (unsigned*)(sq + p.sq_off.tail);
+    ring->sqMask = *(unsigned*)(sq + p.sq_off.ring_mask);
+    ring->sqArray = (unsigned*)(sq + p.sq_off.array);
+    ring->cqHead = (unsigned*)(cq + p.cq_off.head);
+    ring->cqTail = (unsigned*)(cq + p.cq_off.tail);
+    ring->cqMask = *(unsigned*)(cq + p.cq_off.ring_mask);
+    ring->cqes = (struct io_uring_cqe*)(cq + p.cq_off.cqes);
+    return 1;
+
+fail:
+    close(ring->fd);
+    return 0;
+}
+
+/**
+ * @brief Unmaps and closes an io_uring instance
+ * @param ring Ring to destroy
+ */
+static void ring_destroy(Ring* ring) {
+    munmap(ring->sqes, ring->sqesSize);
+    if (ring->cqMap != ring->sqMap) munmap(ring->cqMap, ring->cqMapSize);
+    munmap(ring->sqMap, ring->sqMapSize);
+    close(ring->fd);
+}
+
+/**
+ * @brief Queues one read or write on the submission ring
+ * @param ring Ring
+ * @param fd Target file
+ * @param isRead Operation type
+ * @param buf Request buffer
+ * @param len Request length
+ * @param off File offset
+ * @param userData Slot index returned in the completion
+ */
+static void ring_queue(Ring* ring, int fd, int isRead, void* buf, uint32_t len,
+                       uint64_t off, uint64_t userData) {
+    unsigned tail = *ring->sqTail;
+    unsigned idx = tail & ring->sqMask;
+    struct io_uring_sqe* sqe = &ring->sqes[idx];
+
+    memset(sqe, 0, sizeof(*sqe));
+    sqe->opcode = isRead ? IORING_OP_READ : IORING_OP_WRITE;
+    sqe->fd = fd;
+    sqe->addr = (uint64_t)(uintptr_t)buf;
+    sqe->len = len;
+    sqe->off = off;
+    sqe->user_data = userData;
+
+    ring->sqArray[idx] = idx;
+    __atomic_store_n(ring->sqTail, tail + 1, __ATOMIC_RELEASE);
+}
+
+/**
+ * @brief Submits queued entries and optionally waits for completions
+ * @param ring Ring
+ * @param toSubmit Entries queued since the last call
+ * @param waitFor Completions to wait for
+ * @return Result of io_uring_enter
+ */
+static int ring_enter(Ring* ring, unsigned toSubmit, unsigned waitFor) {
+    return (int)syscall(__NR_io_uring_enter, ring->fd, toSubmit, waitFor,
+                        waitFor ? IORING_ENTER_GETEVENTS : 0, NULL, 0);
+}
+
+/**
+ * @brief Queues the next operation of the workload into a slot
+ * @param w Workload
+ * @param ring Ring
+ * @param slots Slot array
+ * @param s Slot index
+ */
+static void uring_issue(Workload* w, Ring* ring, Slot* slots, int s) {
+    uint64_t op = w->nextOp++;
+    slots[s].isRead = op_is_read(w->cfg, op);
+    slots[s].submitNs = now_ns();
+    ring_queue(ring, w->fd, slots[s].isRead, slots[s].buf, w->cfg->blockSize,
+               op_offset(w, op), (uint64_t)s);
+}
+
+/**
+ * @brief Runs the workload through io_uring from a single thread
+ * @param w Workload
+ * @param[out] res Results
+ * @return 1 on success, 0 if io_uring is unavailable or rejects the opcodes,
+ *         -1 on a failure after I/O has started
+ */
+static int run_uring(Workload* w, Results* res) {
+    int qd = w->cfg->queueDepth;
+    Ring ring;
+    if (!ring_init(&ring, (unsigned)qd)) return 0;
+
+    Slot* slots = (Slot*)calloc((size_t)qd, sizeof(Slot));
+    if (!slots) {
+        ring_destroy(&ring);
+        return -1;
+    }
+    int ok = 1;
+    for (int s = 0; s < qd; s++) {
+        slots[s].buf = alloc_buffer(w->cfg->blockSize);
+        if (!slots[s].buf) ok = 0;
+    }
+    if (!ok) printf("Error: out of memory for I/O buffers\n");
+
+    int inFlight = 0;
+    unsigned pending = 0;
+    int firstCompletion = 1;
+    int unsupported = 0;
+    for (int s = 0; ok && s < qd; s++) {
+        uring_issue(w, &ring, slots, s);
+        pending++;
+        inFlight++;
+    }
+
+    while (ok && inFlight > 0) {
+        int r = ring_enter(&ring, pending, 1);
+        if (r < 0) {
+            if (errno == EINTR) continue;
+            printf("Error: io_uring_enter failed: %s\n", strerror(errno));
+            ok = 0;
+            break;
+        }
+        pending -= (unsigned)r < pending ? (unsigned)r : pending;
+
+        int issuing = !unsupported && now_ns() < w->deadlineNs;
+        unsigned head = *ring.cqHead;
+        unsigned tail = __atomic_load_n(ring.cqTail, __ATOMIC_ACQUIRE);
+        uint64_t done = now_ns();
+        for (; head != tail; head++) {
+            struct io_uring_cqe* cqe = &ring.cqes[head & ring.cqMask];
+            int s = (int)cqe->user_data;
+            inFlight--;
+
+            if (firstCompletion && cqe->res == -EINVAL) {
+                // Kernel predates IORING_OP_READ/WRITE: drain, then let the caller fall back
+                unsupported = 1;
+                issuing = 0;
+            }
+            firstCompletion = 0;
+            if (unsupported) continue;
+
+            uint64_t lat = done - slots[s].submitNs;
+            if (cqe->res != (int)w->cfg->blockSize) {
+                res->errors++;
+            } else if (slots[s].isRead) {
+                res->readOps++;
+                hist_add(&res->readLat, lat);
+            } else {
+                res->writeOps++;
+                hist_add(&res->writeLat, lat);
+            }
+
+            if (issuing) {
+                uring_issue(w, &ring, slots, s);
+                pending++;
+                inFlight++;
+            }
+        }
+        __atomic_store_n(ring.cqHead, head, __ATOMIC_RELEASE);
+    }
+
+    // Tear the ring down first so no request can still target a buffer
+    ring_destroy(&ring);
+    for (int s = 0; s < qd; s++) free(slots[s].buf);
+    free(slots);
+    if (unsupported) {
+        memset(res, 0, sizeof(*res));
+        w->nextOp = 0;
+        return 0;
+    }
+    return ok ? 1 : -1;
+}
+
+/* ---------------------------------------------------------------------- */
+/* Setup and reporting                                                     */
+/* ---------------------------------------------------------------------- */
+
+/**
+ * @brief Reads the counters of the device backing a file from /proc/diskstats
+ * @param dev Device number of the file system (st_dev)
+ * @param[out] stats Device counters
+ * @return 1 if the device was found, 0 otherwise
+ */
+static int read_disk_stats(dev_t dev, DiskStats* stats) {
+    FILE* f = fopen("/proc/diskstats", "r");
+    if (!f) return 0;
+
+    char line[512];
+    int found = 0;
+    while (!found && fgets(line, sizeof(line), f)) {
+        unsigned maj, min;
+        unsigned long long rd, rdMerged, rdSectors, rdMs, wr, wrMerged, wrSectors;
+        if (sscanf(line, "%u %u %*s %llu %llu %llu %llu %llu %llu %llu",
+                   &maj, &min, &rd, &rdMerged, &rdSectors, &rdMs,
+                   &wr, &wrMerged, &wrSectors) != 9) continue;
+        if (maj != major(dev) || min != minor(dev)) continue;
+
+        // diskstats always counts 512-byte sectors
+        stats->readOps = rd;
+        stats->writeOps = wr;
+        stats->readBytes = rdSectors * 512ull;
+        stats->writeBytes = wrSectors * 512ull;
+        found = 1;
+    }
+    fclose(f);
+    return found;
+}
+
+/**
+ * @brief Creates the test file and writes every block once
+ *
+ * Reading never-written blocks can be served without touching the device,
+ * which would skew the measured ratio, so the whole file is written up front.
+ *
+ * @param cfg Workload parameters
+ * @return 1 on success, 0 on failure
+ */
+static int prepare_file(const Config* cfg) {
+    struct stat st;
+    if (stat(cfg->path, &st) == 0 && (uint64_t)st.st_size >= cfg->fileSize) return 1;
+
+    printf("Preparing %s (%llu MB)...\n", cfg->path,
+           (unsigned long long)(cfg->fileSize / (1024 * 1024)));
+    int fd = open(cfg->path, O_WRONLY | O_CREAT, 0644);
+    if (fd < 0) {
+        printf("Error creating %s: %s\n", cfg->path, strerror(errno));
+        return 0;
+    }
+    void* buf = alloc_buffer(FILL_CHUNK);
+    if (!buf) {
+        close(fd);
+        return 0;
+    }
+    for (uint64_t off = 0; off < cfg->fileSize; off += FILL_CHUNK) {
+        size_t len = cfg->fileSize - off < FILL_CHUNK ? (size_t)(cfg->fileSize - off) : FILL_CHUNK;
+        if (pwrite(fd, buf, len, (off_t)off) != (ssize_t)len) {
+            printf("Error writing %s: %s\n", cfg->path, strerror(errno));
+            free(buf);
+            close(fd);
+            return 0;
+        }
+    }
+    fsync(fd);
+    free(buf);
+    close(fd);
+    return 1;
+}
+
+/**
+ * @brief Prints latency percentiles of one operation type
+ * @param name Operation name
+ * @param h Latency histogram
+ */
+static void print_latency(const char* name, const Histogram* h) {
+    if (h->total == 0) {
+        printf("  %-6s  (none)\n", name);
+        return;
+    }
+    printf("  %-6s  p50 %8.1f  p90 %8.1f  p99 %8.1f  p99.9 %8.1f  max %8.1f us\n", name,
+           hist_percentile(h, 50.0) / 1000.0, hist_percentile(h, 90.0) / 1000.0,
+           hist_percentile(h, 99.0) / 1000.0, hist_percentile(h, 99.9) / 1000.0,
+           h->max / 1000.0);
+}
+
+/**
+ * @brief Compares the configured ratio with the ratio measured on the device
+ * @param cfg Workload parameters
+ * @param before Device counters before the run
+ * @param after Device counters after the run
+ * @return 1 if within tolerance, 0 otherwise
+ */
+static int check_ratio(const Config* cfg, const DiskStats* before, const DiskStats* after) {
+    uint64_t readOps = after->readOps - before->readOps;
+    uint64_t writeOps = after->writeOps - before->writeOps;
+    uint64_t readBytes = after->readBytes - before->readBytes;
+    uint64_t writeBytes = after->writeBytes - before->writeBytes;
+
+    double opRatio = (writeOps > 0) ? ((double)readOps / writeOps) : 0;
+    double bytesRatio = (writeBytes > 0) ? ((double)readBytes / writeBytes) : 0;
+    double configuredShare = 100.0 * cfg->readWeight / (cfg->readWeight + cfg->writeWeight);
+    double measuredShare = (readBytes + writeBytes) > 0
+                         ? 100.0 * readBytes / (readBytes + writeBytes) : 0;
+    double deviation = measuredShare > configuredShare ? measuredShare - configuredShare
+                                                       : configuredShare - measuredShare;
+
+    printf("Device (/proc/diskstats):\n");
+    printf("  Read operations:  %llu\n", (unsigned long long)readOps);
+    printf("  Write operations: %llu\n", (unsigned long long)writeOps);
+    printf("  Read/Write ratio: %.2f:1\n", opRatio);
+    printf("  Bytes ratio:      %.2f:1\n", bytesRatio);
+    printf("  Read share of bytes: measured %.2f%%, configured %.2f%% (tolerance %.2f points)\n",
+           measuredShare, configuredShare, cfg->tolerancePct);
+
+    int pass = deviation <= cfg->tolerancePct;
+    printf("  Ratio check: %s\n", pass ? "PASS" : "FAIL");
+    if (!pass && !cfg->direct) {
+        printf("  Note: without -D reads may be served from the page cache.\n");
+    }
+    return pass;
+}
+
+/**
+ * @brief Prints command line usage
+ * @param prog Program name
+ */
+static void usage(const char* prog) {
+    printf("Usage: %s -f file [options]\n", prog);
+    printf("  -f  Test file (created and pre-filled if missing or too small)\n");
+    printf("  -s  File size in MB (default %d)\n", DEFAULT_FILE_MB);
+    printf("  -b  Block size in bytes (default %d)\n", DEFAULT_BLOCK_SIZE);
+    printf("  -q  Queue depth (default %d)\n", DEFAULT_QUEUE_DEPTH);
+    printf("  -m  Read:write ratio, e.g. 70:30 (default 50:50)\n");
+    printf("  -p  Access pattern: seq or rand (default rand)\n");
+    printf("  -D  Use O_DIRECT\n");
+    printf("  -t  Duration in seconds (default %d)\n", DEFAULT_DURATION_SEC);
+    printf("  -e  Engine: auto, uring or threads (default auto)\n");
+    printf("  -T  Ratio tolerance in percentage points (default %.1f)\n", DEFAULT_TOLERANCE_PCT);
+}
+
+/**
+ * @brief Main program entry point
+ *
+ * Parses the workload, runs it for the configured duration, then reports
+ * throughput, latency percentiles and the device-level read/write ratio.
+ *
+ * @return 0 on success, 1 on failure, 2 if the ratio check failed
+ */
+int main(int argc, char** argv) {
+    Config cfg = {
+        .path = NULL,
+        .fileSize = (uint64_t)DEFAULT_FILE_MB * 1024 * 1024,
+        .blockSize = DEFAULT_BLOCK_SIZE,
+        .queueDepth = DEFAULT_QUEUE_DEPTH,
+        .readWeight = 50,
+        .writeWeight = 50,
+        .random = 1,
+        .direct = 0,
+        .durationSec = DEFAULT_DURATION_SEC,
+        .tolerancePct = DEFAULT_TOLERANCE_PCT,
+        .engine = ENGINE_AUTO,
+    };
+
+    int opt;
+    while ((opt = getopt(argc, argv, "f:s:b:q:m:p:Dt:e:T:h")) != -1) {
+        switch (opt) {
+        case 'f': cfg.path = optarg; break;
+        case 's': cfg.fileSize = strtoull(optarg, NULL, 10) * 1024 * 1024; break;
+        case 'b': cfg.blockSize = (uint32_t)strtoul(optarg, NULL, 10); break;
+        case 'q': cfg.queueDepth = atoi(optarg); break;
+        case 'm':
+            if (sscanf(optarg, "%d:%d", &cfg.readWeight, &cfg.writeWeight) != 2) cfg.readWeight = -1;
+            break;
+        case 'p': cfg.random = strcmp(optarg, "seq") != 0; break;
+        case 'D': cfg.direct = 1; break;
+        case 't': cfg.durationSec = atoi(optarg); break;
+        case 'e':
+            cfg.engine = strcmp(optarg, "uring") == 0   ? ENGINE_URING
+                       : strcmp(optarg, "threads") == 0 ? ENGINE_THREADS : ENGINE_AUTO;
+            break;
+        case 'T': cfg.tolerancePct = atof(optarg); break;
+        default:
+            usage(argv[0]);
+            return opt == 'h' ? 0 : 1;
+        }
+    }
+    if (!cfg.path || cfg.blockSize == 0 || cfg.queueDepth <= 0 || cfg.durationSec <= 0 ||
+        cfg.readWeight < 0 || cfg.writeWeight < 0 || cfg.readWeight + cfg.writeWeight == 0 ||
+        cfg.fileSize < cfg.blockSize) {
+        usage(argv[0]);
+        return 1;
+    }
+    if (cfg.direct && cfg.blockSize % 512 != 0) {
+        printf("Error: O_DIRECT needs a block size that is a multiple of 512\n");
+        return 1;
+    }
+
+    printf("Synthetic I/O Load Generator for Linux\n");
+    printf("--------------------------------------\n");
+    printf("File: %s, %llu MB, block %u bytes, queue depth %d\n", cfg.path,
+           (unsigned long long)(cfg.fileSize / (1024 * 1024)), cfg.blockSize, cfg.queueDepth);
+    printf("Mix: %d:%d read:write, %s, %s, %d seconds\n\n", cfg.readWeight, cfg.writeWeight,
+           cfg.random ? "random" : "sequential", cfg.direct ? "O_DIRECT" : "buffered",
+           cfg.durationSec);
+
+    if (!prepare_file(&cfg)) return 1;
+
+    Workload w;
+    memset(&w, 0, sizeof(w));
+    w.cfg = &cfg;
+    w.blocks = cfg.fileSize / cfg.blockSize;
+    w.fd = open(cfg.path, O_RDWR | (cfg.direct ? O_DIRECT : 0));
+    if (w.fd < 0) {
+        printf("Error opening %s: %s\n", cfg.path, strerror(errno));
+        return 1;
+    }
+
+    struct stat st;
+    fstat(w.fd, &st);
+    DiskStats before, after;
+    int haveDisk = read_disk_stats(st.st_dev, &before);
+
+    Results res;
+    memset(&res, 0, sizeof(res));
+    const char* engineName = "io_uring";
+    uint64_t start = now_ns();
+    w.deadlineNs = start + (uint64_t)cfg.durationSec * 1000000000ull;
+
+    int ok = 0;
+    if (cfg.engine != ENGINE_THREADS) ok = run_uring(&w, &res);
+    if (ok < 0) {
+        // Partial results from a broken run must not be mixed with a fallback run
+        close(w.fd);
+        return 1;
+    }
+    if (!ok && cfg.engine == ENGINE_URING) {
+        printf("Error: io_uring is not available\n");
+        close(w.fd);
+        return 1;
+    }
+    if (!ok) {
+        engineName = "thread pool (pread/pwrite)";
+        start = now_ns();
+        w.deadlineNs = start + (uint64_t)cfg.durationSec * 1000000000ull;
+        ok = run_threads(&w, &res);
+    }
+    if (!cfg.direct) fsync(w.fd);
+    double elapsed = (now_ns() - start) / 1e9;
+    close(w.fd);
+    if (!ok) return 1;
+
+    uint64_t ops = res.readOps + res.writeOps;
+    double mb = (double)ops * cfg.blockSize / (1024.0 * 1024.0);
+    printf("Engine: %s\n\n", engineName);
+    printf("Results:\n");
+    printf("--------\n");
+    printf("Read operations:  %llu\n", (unsigned long long)res.readOps);
+    printf("Write operations: %llu\n", (unsigned long long)res.writeOps);
+    printf("Errors:           %llu\n", (unsigned long long)res.errors);
+    printf("Read/Write ratio: %.2f:1\n", res.writeOps ? (double)res.readOps / res.writeOps : 0);
+    printf("Throughput:       %.0f IOPS, %.2f MB/s\n\n", ops / elapsed, mb / elapsed);
+    printf("Latency:\n");
+    print_latency("read", &res.readLat);
+    print_latency("write", &res.writeLat);
+    printf("\n");
+
+    if (!haveDisk || !read_disk_stats(st.st_dev, &after)) {
+        printf("Device %u:%u not found in /proc/diskstats; skipping ratio check\n",
+               major(st.st_dev), minor(st.st_dev));
+        return 0;
+    }
+    return check_ratio(&cfg, &before, &after) ? 0 : 2;
+}
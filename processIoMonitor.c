@@ -0,0 +1,793 @@
+/**
+ * @file processIoMonitor.c
+ * @brief Linux per-process I/O attribution from /proc/[pid]/io and /proc/[pid]/stat
+ *
+ * Scans every process once per interval and ranks the top readers and
+ * writers by storage-level byte rate. The scan is built to stay cheap with
+ * tens of thousands of processes: files are opened relative to a /proc
+ * directory fd, long-lived processes keep their fds open between scans
+ * (re-read with pread at offset 0), and all parsing happens in reused buffers.
+ */
+
+#define _GNU_SOURCE
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <getopt.h>
+#include <signal.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/prctl.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+/**
+ * @brief Default interval between scans in milliseconds
+ */
+#define DEFAULT_INTERVAL_MS 1000
+
+/**
+ * @brief Default monitoring duration in seconds
+ */
+#define DEFAULT_DURATION_SEC 60
+
+/**
+ * @brief Default number of processes listed per ranking
+ */
+#define DEFAULT_TOP_N 10
+
+/**
+ * @brief Upper bound on the number of processes listed per ranking
+ */
+#define MAX_TOP_N 64
+
+/**
+ * @brief Number of scans a process must survive before its fds are cached
+ */
+#define LONG_LIVED_SCANS 2
+
+/**
+ * @brief File descriptors kept free for everything that is not an fd cache entry
+ */
+#define FD_RESERVE 64
+
+/**
+ * @brief Size of the reused read buffer for /proc files
+ */
+#define READ_BUFFER_SIZE 1024
+
+/**
+ * @brief Number of scans timed per process count in benchmark mode
+ */
+#define BENCH_SCANS 5
+
+/**
+ * @brief I/O counters of one process as reported by /proc/[pid]/io
+ */
+typedef struct {
+    uint64_t rchar;        /**< Bytes passed to read-like syscalls */
+    uint64_t wchar;        /**< Bytes passed to write-like syscalls */
+    uint64_t syscr;        /**< Read syscalls */
+    uint64_t syscw;        /**< Write syscalls */
+    uint64_t readBytes;    /**< Bytes fetched from storage */
+    uint64_t writeBytes;   /**< Bytes sent to storage */
+} ProcIO;
+
+/**
+ * @brief Tracked state for one process, stored in an open-addressing table
+ */
+typedef struct {
+    int pid;               /**< Process id, 0 marks an empty slot */
+    int ioFd;              /**< Cached fd of /proc/[pid]/io, -1 if not cached */
+    int statFd;            /**< Cached fd of /proc/[pid]/stat, -1 if not cached */
+    int noAccess;          /**< Set when /proc/[pid]/io cannot be opened */
+    unsigned scans;        /**< Consecutive scans this process was seen in */
+    unsigned seenGen;      /**< Scan generation the process was last seen in */
+    uint64_t startTime;    /**< Start time in clock ticks, identifies pid reuse */
+    ProcIO last;           /**< Counters from the previous scan */
+    double readRate;       /**< Storage read rate in bytes/sec */
+    double writeRate;      /**< Storage write rate in bytes/sec */
+    double readOpsRate;    /**< Read syscalls per second */
+    double writeOpsRate;   /**< Write syscalls per second */
+    char comm[16];         /**< Command name from /proc/[pid]/stat */
+} ProcEntry;
+
+/**
+ * @brief Scanner state reused across intervals
+ */
+typedef struct {
+    int procFd;            /**< Directory fd of /proc */
+    DIR* procDir;          /**< Directory stream over procFd, rewound each scan */
+    ProcEntry* table;      /**< Open-addressing hash table keyed by pid */
+    size_t capacity;       /**< Table capacity, always a power of two */
+    size_t count;          /**< Occupied slots */
+    unsigned generation;   /**< Current scan generation */
+    long fdBudget;         /**< File descriptors still available for caching */
+    long cachedFds;        /**< File descriptors currently cached */
+    char buffer[READ_BUFFER_SIZE]; /**< Reused read buffer */
+} Scanner;
+
+/**
+ * @brief Cost figures for a single scan
+ */
+typedef struct {
+    size_t processes;      /**< Processes visited */
+    size_t opens;          /**< openat() calls issued */
+    double elapsedMs;      /**< Wall time of the scan */
+} ScanStats;
+
+/**
+ * @brief Returns the monotonic clock in seconds
+ * @return Current time in seconds
+ */
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/**
+ * @brief Parses an unsigned decimal number without locale or errno overhead
+ * @param[in,out] p Cursor, advanced past the digits
+ * @return Parsed value
+ */
+static uint64_t parse_u64(const char** p) {
+    const char* s = *p;
+    uint64_t v = 0;
+    while (*s == ' ') s++;
+    while (*s >= '0' && *s <= '9') {
+        v = v * 10 + (uint64_t)(*s - '0');
+        s++;
+    }
+    *p = s;
+    return v;
+}
+
+/**
+ * @brief Parses the contents of /proc/[pid]/io
+ *
+ * The kernel emits the fields in a fixed order, so each value is taken from
+ * the text following the next colon.
+ *
+ * @param text NUL-terminated file contents
+ * @param[out] io Parsed counters
+ * @return 1 on success, 0 if the text is truncated
+ */
+static int parse_io(const char* text, ProcIO* io) {
+    uint64_t* fields[] = { &io->rchar, &io->wchar, &io->syscr, &io->syscw,
+                           &io->readBytes, &io->writeBytes };
+    const char* p = text;
+    for (size_t i = 0; i < sizeof(fields) / sizeof(fields[0]); i++) {
+        p = strchr(p, ':');
+        if (!p) return 0;
+        p++;
+        *fields[i] = parse_u64(&p);
+    }
+    return 1;
+}
+
+/**
+ * @brief Parses the command name and start time from /proc/[pid]/stat
+ * @param text NUL-terminated file contents
+ * @param[out] comm Command name, at least 16 bytes
+ * @param[out] startTime Field 22, the start time in clock ticks
+ * @return 1 on success, 0 on malformed input
+ */
+static int parse_stat(const char* text, char* comm, uint64_t* startTime) {
+    // The command name may itself contain ')' so search from the end
+    const char* open = strchr(text, '(');
+    const char* close = strrchr(text, ')');
+    if (!open || !close || close < open) return 0;
+
+    size_t len = (size_t)(close - open - 1);
+    if (len > 15) len = 15;
+    memcpy(comm, open + 1, len);
+    comm[len] = '\0';
+
+    // Skip to field 22; field 3 (state) follows ") "
+    const char* p = close + 2;
+    for (int field = 3; field < 22; field++) {
+        p = strchr(p, ' ');
+        if (!p) return 0;
+        p++;
+    }
+    *startTime = parse_u64(&p);
+    return 1;
+}
+
+/**
+ * @brief Reads a /proc file into the scanner's buffer
+ *
+ * Cached fds are re-read with pread at offset 0, which makes procfs
+ * regenerate the contents without a new open.
+ *
+ * @param sc Scanner owning the buffer
+ * @param fd Open file descriptor
+ * @return Number of bytes read, or -1 on error (process gone)
+ */
+static ssize_t read_proc_file(Scanner* sc, int fd) {
+    ssize_t n = pread(fd, sc->buffer, sizeof(sc->buffer) - 1, 0);
+    if (n <= 0) {
+        if (n == 0) errno = ESRCH;
+        return -1;
+    }
+    sc->buffer[n] = '\0';
+    return n;
+}
+
+/**
+ * @brief Opens /proc/[pid]/<name> relative to the /proc directory fd
+ * @param sc Scanner holding the directory fd
+ * @param pidName Pid as it appears in the directory listing
+ * @param name File name inside the pid directory
+ * @param stats Scan statistics, open count is incremented
+ * @return File descriptor, or -1 on error
+ */
+static int open_pid_file(Scanner* sc, const char* pidName, const char* name, ScanStats* stats) {
+    char path[sizeof(((struct dirent*)0)->d_name) + 8];
+    snprintf(path, sizeof(path), "%s/%s", pidName, name);
+    stats->opens++;
+    return openat(sc->procFd, path, O_RDONLY | O_CLOEXEC);
+}
+
+/**
+ * @brief Closes any fds cached by an entry and returns them to the budget
+ * @param sc Scanner owning the budget
+ * @param e Entry to release
+ */
+static void release_fds(Scanner* sc, ProcEntry* e) {
+    if (e->ioFd >= 0) {
+        close(e->ioFd);
+        e->ioFd = -1;
+        sc->cachedFds--;
+        sc->fdBudget++;
+    }
+    if (e->statFd >= 0) {
+        close(e->statFd);
+        e->statFd = -1;
+        sc->cachedFds--;
+        sc->fdBudget++;
+    }
+}
+
+/**
+ * @brief Hashes a pid to a table slot
+ * @param sc Scanner owning the table
+ * @param pid Process id
+ * @return Slot index
+ */
+static size_t slot_of(const Scanner* sc, int pid) {
+    return ((uint32_t)pid * 2654435761u) & (sc->capacity - 1);
+}
+
+/**
+ * @brief Removes the entry at a slot using backward-shift deletion
+ * @param sc Scanner owning the table
+ * @param i Slot to clear
+ */
+static void table_remove(Scanner* sc, size_t i) {
+    size_t mask = sc->capacity - 1;
+    release_fds(sc, &sc->table[i]);
+    sc->table[i].pid = 0;
+    sc->count--;
+
+    size_t j = i;
+    for (;;) {
+        j = (j + 1) & mask;
+        if (sc->table[j].pid == 0) break;
+        size_t home = slot_of(sc, sc->table[j].pid);
+        // Move the entry back if its home slot is not in (i, j]
+        if (((j - home) & mask) >= ((j - i) & mask)) {
+            sc->table[i] = sc->table[j];
+            sc->table[j].pid = 0;
+            i = j;
+        }
+    }
+}
+
+/**
+ * @brief Doubles the table capacity and rehashes all entries
+ * @param sc Scanner owning the table
+ */
+static void table_grow(Scanner* sc) {
+    ProcEntry* old = sc->table;
+    size_t oldCapacity = sc->capacity;
+
+    sc->capacity *= 2;
+    sc->table = (ProcEntry*)calloc(sc->capacity, sizeof(ProcEntry));
+    if (!sc->table) {
+        printf("Error: Could not grow process table to %zu entries\n", sc->capacity);
+        exit(1);
+    }
+    for (size_t i = 0; i < oldCapacity; i++) {
+        if (old[i].pid == 0) continue;
+        size_t j = slot_of(sc, old[i].pid);
+        while (sc->table[j].pid != 0) j = (j + 1) & (sc->capacity - 1);
+        sc->table[j] = old[i];
+    }
+    free(old);
+}
+
+/**
+ * @brief Finds the entry for a pid, inserting a fresh one if absent
+ * @param sc Scanner owning the table
+ * @param pid Process id
+ * @param[out] created Set to 1 if a new entry was inserted
+ * @return Pointer to the entry
+ */
+static ProcEntry* table_lookup(Scanner* sc, int pid, int* created) {
+    if ((sc->count + 1) * 4 > sc->capacity * 3) table_grow(sc);
+
+    size_t i = slot_of(sc, pid);
+    while (sc->table[i].pid != 0) {
+        if (sc->table[i].pid == pid) {
+            *created = 0;
+            return &sc->table[i];
+        }
+        i = (i + 1) & (sc->capacity - 1);
+    }
+
+    ProcEntry* e = &sc->table[i];
+    memset(e, 0, sizeof(*e));
+    e->pid = pid;
+    e->ioFd = -1;
+    e->statFd = -1;
+    sc->count++;
+    *created = 1;
+    return e;
+}
+
+/**
+ * @brief Initializes the scanner and sizes the fd cache from RLIMIT_NOFILE
+ * @param sc Scanner to initialize
+ * @return 1 on success, 0 on failure
+ */
+static int scanner_init(Scanner* sc) {
+    memset(sc, 0, sizeof(*sc));
+
+    sc->procFd = open("/proc", O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (sc->procFd < 0) {
+        printf("Error opening /proc: %s\n", strerror(errno));
+        return 0;
+    }
+    // fdopendir takes ownership, so give it its own descriptor
+    sc->procDir = fdopendir(dup(sc->procFd));
+    if (!sc->procDir) {
+        printf("Error reading /proc: %s\n", strerror(errno));
+        close(sc->procFd);
+        return 0;
+    }
+
+    // Raise the soft fd limit as far as allowed and spend it on the cache
+    struct rlimit rl;
+    if (getrlimit(RLIMIT_NOFILE, &rl) == 0) {
+        rl.rlim_cur = rl.rlim_max;
+        setrlimit(RLIMIT_NOFILE, &rl);
+        getrlimit(RLIMIT_NOFILE, &rl);
+        sc->fdBudget = (long)rl.rlim_cur - FD_RESERVE;
+    }
+    if (sc->fdBudget < 0) sc->fdBudget = 0;
+
+    sc->capacity = 1024;
+    sc->table = (ProcEntry*)calloc(sc->capacity, sizeof(ProcEntry));
+    if (!sc->table) {
+        printf("Error: Could not allocate process table\n");
+        return 0;
+    }
+    return 1;
+}
+
+/**
+ * @brief Releases every cached fd and the table
+ * @param sc Scanner to destroy
+ */
+static void scanner_destroy(Scanner* sc) {
+    for (size_t i = 0; i < sc->capacity; i++) {
+        if (sc->table[i].pid != 0) release_fds(sc, &sc->table[i]);
+    }
+    free(sc->table);
+    closedir(sc->procDir);
+    close(sc->procFd);
+}
+
+/**
+ * @brief Drops every tracked process so the next scan starts cold
+ * @param sc Scanner to reset
+ */
+static void scanner_reset(Scanner* sc) {
+    for (size_t i = 0; i < sc->capacity; i++) {
+        if (sc->table[i].pid != 0) release_fds(sc, &sc->table[i]);
+    }
+    memset(sc->table, 0, sc->capacity * sizeof(ProcEntry));
+    sc->count = 0;
+}
+
+/**
+ * @brief Reads one process's stat and io files and updates its rates
+ * @param sc Scanner
+ * @param e Entry of the process
+ * @param pidName Pid as it appears in the directory listing
+ * @param elapsed Seconds since the previous scan, 0 on the first scan
+ * @param created Whether the entry was inserted during this scan
+ * @param stats Scan statistics
+ * @return 1 if the process is still alive, 0 if it has exited
+ */
+static int sample_process(Scanner* sc, ProcEntry* e, const char* pidName,
+                          double elapsed, int created, ScanStats* stats) {
+    int cache = e->scans + 1 >= LONG_LIVED_SCANS;
+
+    // stat: identifies pid reuse through the start time
+    int fd = e->statFd;
+    if (fd < 0) fd = open_pid_file(sc, pidName, "stat", stats);
+    if (fd < 0 || read_proc_file(sc, fd) < 0) {
+        if (fd >= 0 && fd != e->statFd) close(fd);
+        return 0;
+    }
+    uint64_t startTime = 0;
+    if (!parse_stat(sc->buffer, e->comm, &startTime)) {
+        if (fd != e->statFd) close(fd);
+        return 0;
+    }
+    if (fd != e->statFd) {
+        if (cache && sc->fdBudget > 0) {
+            e->statFd = fd;
+            sc->fdBudget--;
+            sc->cachedFds++;
+        } else {
+            close(fd);
+        }
+    }
+    if (!created && startTime != e->startTime) {
+        // Same pid, different process: restart its history
+        release_fds(sc, e);
+        e->scans = 0;
+        e->noAccess = 0;
+        created = 1;
+        cache = 0;
+    }
+    e->startTime = startTime;
+
+    // io: may be refused for other users' processes without privileges
+    if (e->noAccess) return 1;
+    fd = e->ioFd;
+    if (fd < 0) fd = open_pid_file(sc, pidName, "io", stats);
+    if (fd < 0) {
+        if (errno == EACCES || errno == EPERM) {
+            e->noAccess = 1;
+            return 1;
+        }
+        return 0;
+    }
+    ProcIO io;
+    int readFailed = read_proc_file(sc, fd) < 0;
+    if (readFailed || !parse_io(sc->buffer, &io)) {
+        // procfs checks access on read as well as on open
+        int denied = readFailed && (errno == EACCES || errno == EPERM);
+        if (fd != e->ioFd) close(fd);
+        if (denied) {
+            e->noAccess = 1;
+            return 1;
+        }
+        return 0;
+    }
+    if (fd != e->ioFd) {
+        if (cache && sc->fdBudget > 0) {
+            e->ioFd = fd;
+            sc->fdBudget--;
+            sc->cachedFds++;
+        } else {
+            close(fd);
+        }
+    }
+
+    if (!created && elapsed > 0) {
+        e->readRate = (io.readBytes - e->last.readBytes) / elapsed;
+        e->writeRate = (io.writeBytes - e->last.writeBytes) / elapsed;
+        e->readOpsRate = (io.syscr - e->last.syscr) / elapsed;
+        e->writeOpsRate = (io.syscw - e->last.syscw) / elapsed;
+    } else {
+        e->readRate = e->writeRate = 0;
+        e->readOpsRate = e->writeOpsRate = 0;
+    }
+    e->last = io;
+    return 1;
+}
+
+/**
+ * @brief Scans every process in /proc once
+ * @param sc Scanner
+ * @param elapsed Seconds since the previous scan, 0 on the first scan
+ * @param[out] stats Cost of this scan
+ */
+static void scan_processes(Scanner* sc, double elapsed, ScanStats* stats) {
+    double start = now_sec();
+    memset(stats, 0, sizeof(*stats));
+    sc->generation++;
+
+    rewinddir(sc->procDir);
+    struct dirent* de;
+    while ((de = readdir(sc->procDir)) != NULL) {
+        const char* name = de->d_name;
+        if (name[0] < '1' || name[0] > '9') continue;
+        const char* p = name;
+        int pid = (int)parse_u64(&p);
+        if (*p != '\0') continue;
+
+        int created;
+        ProcEntry* e = table_lookup(sc, pid, &created);
+        if (!sample_process(sc, e, name, elapsed, created, stats)) {
+            table_remove(sc, (size_t)(e - sc->table));
+            continue;
+        }
+        e->scans++;
+        e->seenGen = sc->generation;
+        stats->processes++;
+    }
+
+    // Evict processes that disappeared since the last scan
+    for (size_t i = 0; i < sc->capacity; ) {
+        if (sc->table[i].pid != 0 && sc->table[i].seenGen != sc->generation) {
+            // Backward shift may pull another stale entry into slot i
+            table_remove(sc, i);
+        } else {
+            i++;
+        }
+    }
+
+    stats->elapsedMs = (now_sec() - start) * 1000.0;
+}
+
+/**
+ * @brief Selects the processes with the highest value of a rate
+ * @param sc Scanner
+ * @param offset Byte offset of the double rate field inside ProcEntry
+ * @param top Output array of entry pointers, sorted descending
+ * @param n Number of entries requested
+ * @return Number of entries selected
+ */
+static int select_top(const Scanner* sc, size_t offset, const ProcEntry** top, int n) {
+    int found = 0;
+    for (size_t i = 0; i < sc->capacity; i++) {
+        const ProcEntry* e = &sc->table[i];
+        if (e->pid == 0) continue;
+        double v = *(const double*)((const char*)e + offset);
+        if (v <= 0) continue;
+        if (found == n && v <= *(const double*)((const char*)top[n - 1] + offset)) continue;
+
+        // Insertion into the small sorted array
+        int j = (found < n) ? found++ : n - 1;
+        while (j > 0 && *(const double*)((const char*)top[j - 1] + offset) < v) {
+            top[j] = top[j - 1];
+            j--;
+        }
+        top[j] = e;
+    }
+    return found;
+}
+
+/**
+ * @brief Prints one ranking table
+ * @param title Table heading
+ * @param top Ranked entries
+ * @param count Number of entries
+ */
+static void print_ranking(const char* title, const ProcEntry** top, int count) {
+    printf("%s\n", title);
+    printf("  %7s  %-16s %12s %12s %10s %10s\n",
+           "PID", "COMMAND", "READ MB/s", "WRITE MB/s", "RD ops/s", "WR ops/s");
+    if (count == 0) printf("  (no storage I/O this interval)\n");
+    for (int i = 0; i < count; i++) {
+        printf("  %7d  %-16s %12.2f %12.2f %10.0f %10.0f\n",
+               top[i]->pid, top[i]->comm,
+               top[i]->readRate / (1024.0 * 1024.0), top[i]->writeRate / (1024.0 * 1024.0),
+               top[i]->readOpsRate, top[i]->writeOpsRate);
+    }
+}
+
+/**
+ * @brief Monitors processes and prints top readers and writers each interval
+ * @param sc Scanner
+ * @param intervalMs Interval between scans
+ * @param durationSec Total monitoring time
+ * @param topN Processes per ranking
+ */
+static void run_monitor(Scanner* sc, int intervalMs, int durationSec, int topN) {
+    const ProcEntry* top[MAX_TOP_N];
+    ScanStats stats;
+
+    double last = now_sec();
+    double end = last + durationSec;
+    scan_processes(sc, 0, &stats);
+
+    while (now_sec() < end) {
+        struct timespec ts = { intervalMs / 1000, (intervalMs % 1000) * 1000000L };
+        nanosleep(&ts, NULL);
+
+        double t = now_sec();
+        scan_processes(sc, t - last, &stats);
+        last = t;
+
+        printf("\n=== %zu processes scanned in %.2f ms (%.2f us/process, %zu opens, %ld fds cached) ===\n",
+               stats.processes, stats.elapsedMs,
+               stats.processes ? stats.elapsedMs * 1000.0 / stats.processes : 0.0,
+               stats.opens, sc->cachedFds);
+
+        int n = select_top(sc, offsetof(ProcEntry, readRate), top, topN);
+        print_ranking("Top readers:", top, n);
+        n = select_top(sc, offsetof(ProcEntry, writeRate), top, topN);
+        print_ranking("Top writers:", top, n);
+        fflush(stdout);
+    }
+}
+
+/**
+ * @brief Forks idle child processes to populate /proc for benchmarking
+ *
+ * The caller resets the scanner first so no cached fd is duplicated into
+ * every child; the children also drop the /proc directory fds.
+ *
+ * @param sc Scanner, with an empty fd cache
+ * @param children Array receiving child pids
+ * @param have Children already running
+ * @param want Target number of children
+ * @return Number of children running after the call
+ */
+static int spawn_children(Scanner* sc, pid_t* children, int have, int want) {
+    while (have < want) {
+        pid_t pid = fork();
+        if (pid < 0) {
+            printf("  Warning: fork failed after %d children: %s\n", have, strerror(errno));
+            break;
+        }
+        if (pid == 0) {
+            prctl(PR_SET_PDEATHSIG, SIGKILL);
+            closedir(sc->procDir);
+            close(sc->procFd);
+            for (;;) pause();
+        }
+        children[have++] = pid;
+    }
+    return have;
+}
+
+/**
+ * @brief Compares two doubles for qsort
+ */
+static int compare_double(const void* a, const void* b) {
+    double x = *(const double*)a, y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+/**
+ * @brief Measures scan time against process count
+ *
+ * For every requested count, idle children are forked until the extra
+ * process count is reached. The first scan after a reset is cold (every
+ * file opened); the following scans run with the fd cache warm.
+ *
+ * @param sc Scanner
+ * @param counts Extra process counts to benchmark, ascending
+ * @param numCounts Number of entries in counts
+ */
+static void run_benchmark(Scanner* sc, const int* counts, int numCounts) {
+    int maxCount = counts[numCounts - 1];
+    pid_t* children = (pid_t*)malloc(sizeof(pid_t) * (maxCount > 0 ? maxCount : 1));
+    if (!children) {
+        printf("Error: Could not allocate child table\n");
+        exit(1);
+    }
+    int running = 0;
+
+    printf("%10s %10s %12s %12s %12s %12s\n",
+           "EXTRA", "PROCESSES", "COLD ms", "WARM ms", "WARM us/proc", "OPENS/scan");
+    for (int c = 0; c < numCounts; c++) {
+        scanner_reset(sc);
+        running = spawn_children(sc, children, running, counts[c]);
+
+        ScanStats stats;
+        double warm[BENCH_SCANS];
+        size_t warmOpens = 0;
+
+        scan_processes(sc, 0, &stats);
+        double cold = stats.elapsedMs;
+        // One more scan promotes everything to long-lived and fills the cache
+        scan_processes(sc, 0, &stats);
+        for (int i = 0; i < BENCH_SCANS; i++) {
+            scan_processes(sc, 0, &stats);
+            warm[i] = stats.elapsedMs;
+            warmOpens += stats.opens;
+        }
+        qsort(warm, BENCH_SCANS, sizeof(double), compare_double);
+        double median = warm[BENCH_SCANS / 2];
+
+        printf("%10d %10zu %12.2f %12.2f %12.3f %12zu\n",
+               running, stats.processes, cold, median,
+               stats.processes ? median * 1000.0 / stats.processes : 0.0,
+               warmOpens / BENCH_SCANS);
+        fflush(stdout);
+    }
+
+    for (int i = 0; i < running; i++) kill(children[i], SIGKILL);
+    for (int i = 0; i < running; i++) waitpid(children[i], NULL, 0);
+    free(children);
+}
+
+/**
+ * @brief Prints command line usage
+ * @param prog Program name
+ */
+static void usage(const char* prog) {
+    printf("Usage: %s [-i interval_ms] [-d duration_sec] [-n top_n] [-b counts]\n", prog);
+    printf("  -i  Interval between scans (default %d ms)\n", DEFAULT_INTERVAL_MS);
+    printf("  -d  Monitoring duration (default %d s)\n", DEFAULT_DURATION_SEC);
+    printf("  -n  Processes per ranking (default %d, max %d)\n", DEFAULT_TOP_N, MAX_TOP_N);
+    printf("  -b  Benchmark scan time with extra idle processes, e.g. 0,1000,10000\n");
+}
+
+/**
+ * @brief Main program entry point
+ *
+ * Either monitors per-process I/O and prints the top readers and writers
+ * each interval, or with -b benchmarks the scan cost against process count.
+ *
+ * @return 0 on success, 1 on failure
+ */
+int main(int argc, char** argv) {
+    int intervalMs = DEFAULT_INTERVAL_MS;
+    int durationSec = DEFAULT_DURATION_SEC;
+    int topN = DEFAULT_TOP_N;
+    int counts[32];
+    int numCounts = 0;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "i:d:n:b:h")) != -1) {
+        switch (opt) {
+        case 'i': intervalMs = atoi(optarg); break;
+        case 'd': durationSec = atoi(optarg); break;
+        case 'n': topN = atoi(optarg); break;
+        case 'b':
+            for (char* tok = strtok(optarg, ","); tok && numCounts < 32; tok = strtok(NULL, ",")) {
+                counts[numCounts++] = atoi(tok);
+            }
+            break;
+        default:
+            usage(argv[0]);
+            return opt == 'h' ? 0 : 1;
+        }
+    }
+    if (intervalMs <= 0 || durationSec <= 0 || topN <= 0 || topN > MAX_TOP_N) {
+        usage(argv[0]);
+        return 1;
+    }
+    for (int i = 1; i < numCounts; i++) {
+        if (counts[i] < counts[i - 1]) {
+            printf("Benchmark counts must be ascending\n");
+            return 1;
+        }
+    }
+
+    Scanner sc;
+    if (!scanner_init(&sc)) return 1;
+
+    printf("Per-Process I/O Monitor for Linux\n");
+    printf("---------------------------------\n");
+    printf("fd cache budget: %ld descriptors\n\n", sc.fdBudget);
+
+    if (numCounts > 0) {
+        run_benchmark(&sc, counts, numCounts);
+    } else {
+        printf("Scanning every %d ms for %d seconds\n", intervalMs, durationSec);
+        if (geteuid() != 0) {
+            printf("Note: /proc/[pid]/io of other users' processes needs root.\n");
+        }
+        run_monitor(&sc, intervalMs, durationSec, topN);
+    }
+
+    scanner_destroy(&sc);
+    return 0;
+}
@@ -0,0 +1,722 @@
+/**
+ * @file traceReplay.c
+ * @brief Linux block-trace replay engine for blkparse text or CSV I/O traces
+ *
+ * Replaces the synthetic inputs of the other programs with recorded
+ * workloads: a trace is parsed, replayed against a file with its original
+ * timing (optionally scaled) or as fast as possible, and the achieved IOPS,
+ * latency and lag behind the trace's timestamps are reported. The unique
+ * blocks the trace writes are also counted, which is the data a
+ * copy-on-write layer (see containerStorage.c) would have to copy up.
+ *
+ * Accepted input, detected per line:
+ *  - blkparse default output, e.g. "8,0 3 1 0.000000000 697 Q W 223490 + 8 [proc]"
+ *  - CSV "timestamp_sec,op,offset_bytes,size_bytes" with op R/W (header lines skipped)
+ */
+
+#define _GNU_SOURCE
+#include <errno.h>
+#include <fcntl.h>
+#include <getopt.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+/**
+ * @brief Default number of replay threads
+ */
+#define DEFAULT_THREADS 4
+
+/**
+ * @brief Default blkparse action replayed (Q = queued to the block layer)
+ */
+#define DEFAULT_ACTION 'Q'
+
+/**
+ * @brief Largest request replayed; bigger trace records are clamped
+ */
+#define MAX_REQUEST_BYTES (4 * 1024 * 1024)
+
+/**
+ * @brief Granularity of offsets and sizes, sufficient for O_DIRECT
+ */
+#define IO_ALIGN 4096
+
+/**
+ * @brief Smallest and largest default target file size in MB; -s overrides
+ */
+#define MIN_DEFAULT_FILE_MB 64
+#define MAX_DEFAULT_FILE_MB 1024
+
+/**
+ * @brief Chunk size used while pre-filling the target file
+ */
+#define FILL_CHUNK (1024 * 1024)
+
+/**
+ * @brief Sub-buckets per power of two in the latency histogram
+ */
+#define HIST_SUB_BITS 4
+
+/**
+ * @brief Number of latency histogram buckets (covers up to ~2^40 ns)
+ */
+#define HIST_BUCKETS (40 << HIST_SUB_BITS)
+
+/**
+ * @brief One trace record
+ */
+typedef struct {
+    uint64_t timeNs;         /**< Time since the first record */
+    uint64_t offset;         /**< Byte offset on the traced device */
+    uint32_t length;         /**< Request length in bytes, at most MAX_REQUEST_BYTES */
+    uint8_t isWrite;         /**< 1 for a write, 0 for a read */
+} TraceRecord;
+
+/**
+ * @brief Parsed trace
+ */
+typedef struct {
+    TraceRecord* records;    /**< Records in trace order */
+    size_t count;            /**< Number of records */
+    size_t capacity;         /**< Allocated records */
+    size_t skipped;          /**< Lines that were not replayable records */
+} Trace;
+
+/**
+ * @brief Log-linear latency histogram in nanoseconds
+ */
+typedef struct {
+    uint64_t counts[HIST_BUCKETS]; /**< Samples per bucket */
+    uint64_t total;                /**< Number of samples */
+    uint64_t max;                  /**< Largest sample */
+} Histogram;
+
+/**
+ * @brief Per-thread results, merged after the replay
+ */
+typedef struct {
+    Histogram readLat;       /**< Read latencies */
+    Histogram writeLat;      /**< Write latencies */
+    Histogram lag;           /**< Issue time minus scheduled time */
+    uint64_t readOps;        /**< Completed reads */
+    uint64_t writeOps;       /**< Completed writes */
+    uint64_t bytes;          /**< Bytes transferred */
+    uint64_t errors;         /**< Failed or short requests */
+} Results;
+
+/**
+ * @brief Target range of the request a replay thread has in flight
+ *
+ * Written only by its thread while it holds the turn, so a thread that holds
+ * the turn sees stable ranges for every active entry.
+ */
+typedef struct {
+    uint64_t start;          /**< First byte */
+    uint64_t end;            /**< One past the last byte */
+    int active;              /**< Whether the request is still in flight */
+} InFlight;
+
+/**
+ * @brief State shared between replay threads
+ */
+typedef struct {
+    const Trace* trace;      /**< Trace to replay */
+    int fd;                  /**< Target file */
+    uint64_t fileSize;       /**< Target file size */
+    double speed;            /**< Timing scale, 0 for as fast as possible */
+    uint64_t startNs;        /**< Monotonic time of trace time 0, set once all threads run */
+    uint64_t next;           /**< Next record to claim, shared atomically */
+    uint64_t turn;           /**< Next record allowed to dispatch */
+    InFlight* inflight;      /**< One entry per replay thread */
+    int threads;             /**< Number of entries in inflight */
+} Replay;
+
+/**
+ * @brief Arguments of one replay thread
+ */
+typedef struct {
+    Replay* r;               /**< Shared replay state */
+    int index;               /**< Entry of this thread in Replay::inflight */
+    void* buf;               /**< Aligned, pre-touched request buffer */
+    Results res;             /**< Results of this thread */
+} ReplayThread;
+
+/**
+ * @brief Returns the monotonic clock in nanoseconds
+ * @return Current time in nanoseconds
+ */
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+/**
+ * @brief Maps a latency to its histogram bucket
+ * @param v Latency in nanoseconds
+ * @return Bucket index
+ */
+static int hist_bucket(uint64_t v) {
+    if (v < (1u << HIST_SUB_BITS)) return (int)v;
+    int msb = 63 - __builtin_clzll(v);
+    int shift = msb - HIST_SUB_BITS;
+    int idx = ((shift + 1) << HIST_SUB_BITS) + (int)((v >> shift) & ((1u << HIST_SUB_BITS) - 1));
+    return idx < HIST_BUCKETS ? idx : HIST_BUCKETS - 1;
+}
+
+/**
+ * @brief Returns the lower bound of a histogram bucket
+ * @param idx Bucket index
+ * @return Smallest latency in nanoseconds mapping to the bucket
+ */
+static uint64_t hist_value(int idx) {
+    if (idx < (1 << HIST_SUB_BITS)) return (uint64_t)idx;
+    int shift = (idx >> HIST_SUB_BITS) - 1;
+    uint64_t sub = (uint64_t)(idx & ((1 << HIST_SUB_BITS) - 1));
+    return ((1ull << HIST_SUB_BITS) | sub) << shift;
+}
+
+/**
+ * @brief Records one sample
+ * @param h Histogram
+ * @param v Value in nanoseconds
+ */
+static void hist_add(Histogram* h, uint64_t v) {
+    h->counts[hist_bucket(v)]++;
+    h->total++;
+    if (v > h->max) h->max = v;
+}
+
+/**
+ * @brief Adds all samples of one histogram to another
+ * @param dst Destination histogram
+ * @param src Source histogram
+ */
+static void hist_merge(Histogram* dst, const Histogram* src) {
+    for (int i = 0; i < HIST_BUCKETS; i++) dst->counts[i] += src->counts[i];
+    dst->total += src->total;
+    if (src->max > dst->max) dst->max = src->max;
+}
+
+/**
+ * @brief Returns the value at a percentile
+ * @param h Histogram
+ * @param pct Percentile in [0, 100]
+ * @return Value in nanoseconds
+ */
+static uint64_t hist_percentile(const Histogram* h, double pct) {
+    if (h->total == 0) return 0;
+    uint64_t rank = (uint64_t)(pct / 100.0 * h->total + 0.5);
+    if (rank == 0) rank = 1;
+    uint64_t seen = 0;
+    for (int i = 0; i < HIST_BUCKETS; i++) {
+        seen += h->counts[i];
+        if (seen >= rank) return hist_value(i) < h->max ? hist_value(i) : h->max;
+    }
+    return h->max;
+}
+
+/* ---------------------------------------------------------------------- */
+/* Parsing                                                                 */
+/* ---------------------------------------------------------------------- */
+
+/**
+ * @brief Appends a record to the trace
+ * @param t Trace
+ * @param rec Record
+ */
+static void trace_push(Trace* t, const TraceRecord* rec) {
+    if (t->count == t->capacity) {
+        t->capacity = t->capacity ? t->capacity * 2 : 65536;
+        t->records = (TraceRecord*)realloc(t->records, t->capacity * sizeof(TraceRecord));
+        if (!t->records) {
+            printf("Error: Could not allocate %zu trace records\n", t->capacity);
+            exit(1);
+        }
+    }
+    t->records[t->count++] = *rec;
+}
+
+/**
+ * @brief Parses one blkparse output line
+ * @param line Input line
+ * @param action Action to replay, e.g. 'Q' or 'D'
+ * @param[out] sec Timestamp in seconds
+ * @param[out] rec Record, time not yet set
+ * @return 1 for a replayable read or write, 0 otherwise
+ */
+static int parse_blkparse(const char* line, char action, double* sec, TraceRecord* rec) {
+    char act[8], rwbs[8];
+    unsigned long long sector;
+    unsigned count;
+    if (sscanf(line, " %*d,%*d %*d %*u %lf %*d %7s %7s %llu + %u",
+               sec, act, rwbs, &sector, &count) != 5) return 0;
+    if (act[0] != action || act[1] != '\0' || count == 0) return 0;
+
+    // RWBS: R or W plus flags; discards and flush-only requests are skipped
+    if (strchr(rwbs, 'D')) return 0;
+    if (strchr(rwbs, 'W')) rec->isWrite = 1;
+    else if (strchr(rwbs, 'R')) rec->isWrite = 0;
+    else return 0;
+
+    rec->offset = sector * 512ull;
+    rec->length = count > MAX_REQUEST_BYTES / 512 ? MAX_REQUEST_BYTES : count * 512u;
+    return 1;
+}
+
+/**
+ * @brief Parses one CSV line "timestamp_sec,op,offset_bytes,size_bytes"
+ * @param line Input line
+ * @param[out] sec Timestamp in seconds
+ * @param[out] rec Record, time not yet set
+ * @return 1 for a replayable read or write, 0 otherwise
+ */
+static int parse_csv(const char* line, double* sec, TraceRecord* rec) {
+    char op[16];
+    unsigned long long offset, length;
+    if (sscanf(line, " %lf , %15[^,] , %llu , %llu", sec, op, &offset, &length) != 4) return 0;
+    if (length == 0) return 0;
+
+    char c = op[0];
+    if (c == 'W' || c == 'w') rec->isWrite = 1;
+    else if (c == 'R' || c == 'r') rec->isWrite = 0;
+    else return 0;
+
+    rec->offset = offset;
+    rec->length = length > MAX_REQUEST_BYTES ? MAX_REQUEST_BYTES : (uint32_t)length;
+    return 1;
+}
+
+/**
+ * @brief Reads a trace file in either supported format
+ * @param path Trace file, "-" for stdin
+ * @param action blkparse action to replay
+ * @param[out] t Parsed trace
+ * @return 1 on success, 0 on failure
+ */
+static int trace_load(const char* path, char action, Trace* t) {
+    FILE* f = strcmp(path, "-") == 0 ? stdin : fopen(path, "r");
+    if (!f) {
+        printf("Error opening %s: %s\n", path, strerror(errno));
+        return 0;
+    }
+
+    char line[512];
+    double first = -1;
+    while (fgets(line, sizeof(line), f)) {
+        double sec;
+        TraceRecord rec;
+        int ok = strchr(line, ',') && !strchr(line, '+') ? parse_csv(line, &sec, &rec)
+                                                         : parse_blkparse(line, action, &sec, &rec);
+        if (!ok || sec < 0) {
+            t->skipped++;
+            continue;
+        }
+        if (first < 0) first = sec;
+        // Traces can be slightly out of order across CPUs; never go back in time
+        double rel = sec - first;
+        rec.timeNs = rel > 0 ? (uint64_t)(rel * 1e9) : 0;
+        if (t->count > 0 && rec.timeNs < t->records[t->count - 1].timeNs) {
+            rec.timeNs = t->records[t->count - 1].timeNs;
+        }
+        trace_push(t, &rec);
+    }
+    if (f != stdin) fclose(f);
+    return 1;
+}
+
+/* ---------------------------------------------------------------------- */
+/* Footprint                                                               */
+/* ---------------------------------------------------------------------- */
+
+/**
+ * @brief Open-addressing set of block numbers
+ */
+typedef struct {
+    uint64_t* slots;         /**< Block number + 1, 0 marks an empty slot */
+    size_t capacity;         /**< Capacity, a power of two */
+    size_t count;            /**< Members */
+} BlockSet;
+
+/**
+ * @brief Adds a block number to the set
+ * @param s Set
+ * @param block Block number
+ */
+static void blockset_add(BlockSet* s, uint64_t block) {
+    if ((s->count + 1) * 2 > s->capacity) {
+        BlockSet bigger = { NULL, s->capacity ? s->capacity * 2 : 1024, 0 };
+        bigger.slots = (uint64_t*)calloc(bigger.capacity, sizeof(uint64_t));
+        if (!bigger.slots) {
+            printf("Error: Could not grow block set\n");
+            exit(1);
+        }
+        for (size_t i = 0; i < s->capacity; i++) {
+            if (s->slots[i]) blockset_add(&bigger, s->slots[i] - 1);
+        }
+        free(s->slots);
+        *s = bigger;
+    }
+    uint64_t key = block + 1;
+    size_t i = (size_t)((key * 0x9e3779b97f4a7c15ull) >> 20) & (s->capacity - 1);
+    while (s->slots[i]) {
+        if (s->slots[i] == key) return;
+        i = (i + 1) & (s->capacity - 1);
+    }
+    s->slots[i] = key;
+    s->count++;
+}
+
+/**
+ * @brief Prints the unique data read and written by the trace
+ *
+ * Every 4 KiB block the trace writes at least once would be copied up into
+ * a container's private layer by a copy-on-write storage driver.
+ *
+ * @param t Trace
+ */
+static void print_footprint(const Trace* t) {
+    BlockSet readSet = { NULL, 0, 0 }, writeSet = { NULL, 0, 0 };
+    uint64_t readBytes = 0, writeBytes = 0;
+    for (size_t i = 0; i < t->count; i++) {
+        const TraceRecord* rec = &t->records[i];
+        uint64_t firstBlock = rec->offset / IO_ALIGN;
+        uint64_t lastBlock = (rec->offset + rec->length - 1) / IO_ALIGN;
+        for (uint64_t b = firstBlock; b <= lastBlock; b++) {
+            blockset_add(rec->isWrite ? &writeSet : &readSet, b);
+        }
+        if (rec->isWrite) writeBytes += rec->length;
+        else readBytes += rec->length;
+    }
+
+    printf("Trace footprint:\n");
+    printf("  Read:    %.2f MB transferred, %.2f MB unique\n", readBytes / (1024.0 * 1024.0),
+           readSet.count * (double)IO_ALIGN / (1024.0 * 1024.0));
+    printf("  Written: %.2f MB transferred, %.2f MB unique (copy-on-write layer size)\n",
+           writeBytes / (1024.0 * 1024.0), writeSet.count * (double)IO_ALIGN / (1024.0 * 1024.0));
+    free(readSet.slots);
+    free(writeSet.slots);
+}
+
+/* ---------------------------------------------------------------------- */
+/* Replay                                                                  */
+/* ---------------------------------------------------------------------- */
+
+/**
+ * @brief Replay thread body
+ *
+ * Threads claim records in trace order, wait for the record's scheduled
+ * time, then wait for their turn, so requests are dispatched in trace order.
+ * The turn is handed on before the system call so independent requests
+ * overlap, but a request whose range overlaps an earlier one still in flight
+ * waits for it to complete: a read never overtakes the write before it.
+ *
+ * @param arg ReplayThread
+ * @return NULL
+ */
+static void* replay_worker(void* arg) {
+    ReplayThread* t = (ReplayThread*)arg;
+    Replay* r = t->r;
+    const Trace* trace = r->trace;
+    void* buf = t->buf;
+
+    // Hold until every thread is running so startup is not counted as lag
+    while (__atomic_load_n(&r->startNs, __ATOMIC_ACQUIRE) == 0) sched_yield();
+
+    for (;;) {
+        uint64_t i = __atomic_fetch_add(&r->next, 1, __ATOMIC_RELAXED);
+        if (i >= trace->count) break;
+        const TraceRecord* rec = &trace->records[i];
+
+        uint64_t due = r->startNs;
+        if (r->speed > 0) {
+            due += (uint64_t)(rec->timeNs / r->speed);
+            struct timespec ts = { (time_t)(due / 1000000000ull), (long)(due % 1000000000ull) };
+            while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR) {
+            }
+        }
+        while (__atomic_load_n(&r->turn, __ATOMIC_ACQUIRE) != i) sched_yield();
+
+        // Map the traced device range onto the target file
+        uint64_t len = ((uint64_t)rec->length + IO_ALIGN - 1) / IO_ALIGN * IO_ALIGN;
+        if (len > MAX_REQUEST_BYTES) len = MAX_REQUEST_BYTES;
+        if (len > r->fileSize) len = r->fileSize;
+        uint64_t slots = (r->fileSize - len) / IO_ALIGN + 1;
+        uint64_t off = (rec->offset / IO_ALIGN % slots) * IO_ALIGN;
+
+        // Every earlier record has published its range before passing the turn
+        for (int k = 0; k < r->threads; k++) {
+            const InFlight* f = &r->inflight[k];
+            while (__atomic_load_n(&f->active, __ATOMIC_ACQUIRE) &&
+                   f->start < off + len && off < f->end) sched_yield();
+        }
+        InFlight* mine = &r->inflight[t->index];
+        mine->start = off;
+        mine->end = off + len;
+        __atomic_store_n(&mine->active, 1, __ATOMIC_RELAXED);
+
+        uint64_t start = now_ns();
+        __atomic_store_n(&r->turn, i + 1, __ATOMIC_RELEASE);
+        ssize_t n = rec->isWrite ? pwrite(r->fd, buf, (size_t)len, (off_t)off)
+                                 : pread(r->fd, buf, (size_t)len, (off_t)off);
+        uint64_t lat = now_ns() - start;
+        __atomic_store_n(&mine->active, 0, __ATOMIC_RELEASE);
+
+        hist_add(&t->res.lag, start > due ? start - due : 0);
+        if (n != (ssize_t)len) {
+            t->res.errors++;
+        } else if (rec->isWrite) {
+            t->res.writeOps++;
+            t->res.bytes += len;
+            hist_add(&t->res.writeLat, lat);
+        } else {
+            t->res.readOps++;
+            t->res.bytes += len;
+            hist_add(&t->res.readLat, lat);
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief Creates the target file if it is missing or too small
+ * @param path Target file
+ * @param size Required size in bytes
+ * @return 1 on success, 0 on failure
+ */
+static int prepare_file(const char* path, uint64_t size) {
+    struct stat st;
+    if (stat(path, &st) == 0 && (uint64_t)st.st_size >= size) return 1;
+
+    printf("Preparing %s (%llu MB)...\n", path, (unsigned long long)(size / (1024 * 1024)));
+    int fd = open(path, O_WRONLY | O_CREAT, 0644);
+    if (fd < 0) {
+        printf("Error creating %s: %s\n", path, strerror(errno));
+        return 0;
+    }
+    char* buf = (char*)malloc(FILL_CHUNK);
+    if (!buf) {
+        close(fd);
+        return 0;
+    }
+    memset(buf, 0x5A, FILL_CHUNK);
+    for (uint64_t off = 0; off < size; off += FILL_CHUNK) {
+        size_t len = size - off < FILL_CHUNK ? (size_t)(size - off) : FILL_CHUNK;
+        if (pwrite(fd, buf, len, (off_t)off) != (ssize_t)len) {
+            printf("Error writing %s: %s\n", path, strerror(errno));
+            free(buf);
+            close(fd);
+            return 0;
+        }
+    }
+    fsync(fd);
+    free(buf);
+    close(fd);
+    return 1;
+}
+
+/**
+ * @brief Prints percentiles of one histogram in microseconds
+ * @param name Row name
+ * @param h Histogram
+ */
+static void print_hist(const char* name, const Histogram* h) {
+    if (h->total == 0) {
+        printf("  %-6s  (none)\n", name);
+        return;
+    }
+    printf("  %-6s  p50 %9.1f  p90 %9.1f  p99 %9.1f  p99.9 %9.1f  max %9.1f us\n", name,
+           hist_percentile(h, 50.0) / 1000.0, hist_percentile(h, 90.0) / 1000.0,
+           hist_percentile(h, 99.0) / 1000.0, hist_percentile(h, 99.9) / 1000.0,
+           h->max / 1000.0);
+}
+
+/**
+ * @brief Prints command line usage
+ * @param prog Program name
+ */
+static void usage(const char* prog) {
+    printf("Usage: %s -i trace -f file [options]\n", prog);
+    printf("  -i  Trace: blkparse text output or CSV time,op,offset,size (\"-\" for stdin)\n");
+    printf("  -f  Target file (created and pre-filled if missing or too small)\n");
+    printf("  -s  Target file size in MB (default: trace span, %d to %d);\n", MIN_DEFAULT_FILE_MB,
+           MAX_DEFAULT_FILE_MB);
+    printf("      offsets past the end are folded into the file\n");
+    printf("  -j  Replay threads (default %d)\n", DEFAULT_THREADS);
+    printf("  -x  Timing scale: 1 = original, 2 = twice as fast, 0 = as fast as possible (default 1)\n");
+    printf("  -a  blkparse action to replay (default %c)\n", DEFAULT_ACTION);
+    printf("  -D  Use O_DIRECT\n");
+}
+
+/**
+ * @brief Main program entry point
+ *
+ * Loads the trace, replays it against the target file and reports achieved
+ * IOPS, latency percentiles and lag behind the trace's timestamps.
+ *
+ * @return 0 on success, 1 on failure
+ */
+int main(int argc, char** argv) {
+    const char* tracePath = NULL;
+    const char* path = NULL;
+    uint64_t fileSize = 0;
+    int threads = DEFAULT_THREADS;
+    double speed = 1.0;
+    char action = DEFAULT_ACTION;
+    int direct = 0;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "i:f:s:j:x:a:Dh")) != -1) {
+        switch (opt) {
+        case 'i': tracePath = optarg; break;
+        case 'f': path = optarg; break;
+        case 's': fileSize = strtoull(optarg, NULL, 10) * 1024 * 1024; break;
+        case 'j': threads = atoi(optarg); break;
+        case 'x': speed = atof(optarg); break;
+        case 'a': action = optarg[0]; break;
+        case 'D': direct = 1; break;
+        default:
+            usage(argv[0]);
+            return opt == 'h' ? 0 : 1;
+        }
+    }
+    if (!tracePath || !path || threads <= 0 || speed < 0) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    printf("Block Trace Replay for Linux\n");
+    printf("----------------------------\n");
+
+    Trace trace;
+    memset(&trace, 0, sizeof(trace));
+    if (!trace_load(tracePath, action, &trace)) return 1;
+    if (trace.count == 0) {
+        printf("No replayable records in %s (%zu lines skipped)\n", tracePath, trace.skipped);
+        return 1;
+    }
+
+    uint64_t span = 0;
+    for (size_t i = 0; i < trace.count; i++) {
+        uint64_t end = trace.records[i].offset + trace.records[i].length;
+        if (end > span) span = end;
+    }
+    if (fileSize == 0) {
+        // Never create a file as large as a whole traced device unless asked to
+        fileSize = (span + FILL_CHUNK - 1) / FILL_CHUNK * FILL_CHUNK;
+        if (fileSize < MIN_DEFAULT_FILE_MB * 1024ull * 1024) fileSize = MIN_DEFAULT_FILE_MB * 1024ull * 1024;
+        if (fileSize > MAX_DEFAULT_FILE_MB * 1024ull * 1024) fileSize = MAX_DEFAULT_FILE_MB * 1024ull * 1024;
+    }
+    fileSize = fileSize / IO_ALIGN * IO_ALIGN;
+    if (fileSize == 0) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    double traceSec = trace.records[trace.count - 1].timeNs / 1e9;
+    printf("Trace: %zu records over %.3f s (%zu lines skipped)\n", trace.count, traceSec, trace.skipped);
+    printf("Target: %s, %llu MB, %d threads, %s, %s\n\n", path,
+           (unsigned long long)(fileSize / (1024 * 1024)), threads,
+           speed > 0 ? "timed" : "as fast as possible", direct ? "O_DIRECT" : "buffered");
+    if (span > fileSize) {
+        printf("Note: trace reaches %.1f MB; offsets are folded into the %llu MB file.\n"
+               "      Pass -s to replay a larger range.\n\n", span / (1024.0 * 1024.0),
+               (unsigned long long)(fileSize / (1024 * 1024)));
+    }
+    print_footprint(&trace);
+    printf("\n");
+
+    if (!prepare_file(path, fileSize)) return 1;
+    int fd = open(path, O_RDWR | (direct ? O_DIRECT : 0));
+    if (fd < 0) {
+        printf("Error opening %s: %s\n", path, strerror(errno));
+        return 1;
+    }
+
+    Replay r;
+    memset(&r, 0, sizeof(r));
+    r.trace = &trace;
+    r.fd = fd;
+    r.fileSize = fileSize;
+    r.speed = speed;
+
+    ReplayThread* workers = (ReplayThread*)calloc((size_t)threads, sizeof(ReplayThread));
+    pthread_t* ids = (pthread_t*)malloc(sizeof(pthread_t) * (size_t)threads);
+    r.inflight = (InFlight*)calloc((size_t)threads, sizeof(InFlight));
+    r.threads = threads;
+    if (!workers || !ids || !r.inflight) {
+        printf("Error: Could not allocate replay threads\n");
+        return 1;
+    }
+    for (int i = 0; i < threads; i++) {
+        workers[i].r = &r;
+        workers[i].index = i;
+        if (posix_memalign(&workers[i].buf, IO_ALIGN, MAX_REQUEST_BYTES) != 0) {
+            printf("Error: Could not allocate replay buffers\n");
+            return 1;
+        }
+        memset(workers[i].buf, 0xA5, MAX_REQUEST_BYTES);
+    }
+    int started = 0;
+    for (int i = 0; i < threads; i++) {
+        if (pthread_create(&ids[i], NULL, replay_worker, &workers[i]) != 0) break;
+        started++;
+    }
+    if (started == 0) {
+        printf("Error: Could not start replay threads\n");
+        return 1;
+    }
+    __atomic_store_n(&r.startNs, now_ns(), __ATOMIC_RELEASE);
+
+    Results res;
+    memset(&res, 0, sizeof(res));
+    for (int i = 0; i < started; i++) {
+        pthread_join(ids[i], NULL);
+        hist_merge(&res.readLat, &workers[i].res.readLat);
+        hist_merge(&res.writeLat, &workers[i].res.writeLat);
+        hist_merge(&res.lag, &workers[i].res.lag);
+        res.readOps += workers[i].res.readOps;
+        res.writeOps += workers[i].res.writeOps;
+        res.bytes += workers[i].res.bytes;
+        res.errors += workers[i].res.errors;
+    }
+    if (!direct) fsync(fd);
+    double elapsed = (now_ns() - r.startNs) / 1e9;
+    close(fd);
+
+    uint64_t ops = res.readOps + res.writeOps;
+    printf("Results:\n");
+    printf("--------\n");
+    printf("Read operations:  %llu\n", (unsigned long long)res.readOps);
+    printf("Write operations: %llu\n", (unsigned long long)res.writeOps);
+    printf("Errors:           %llu\n", (unsigned long long)res.errors);
+    printf("Read/Write ratio: %.2f:1\n", res.writeOps ? (double)res.readOps / res.writeOps : 0);
+    printf("Achieved:         %.0f IOPS, %.2f MB/s over %.3f s\n", ops / elapsed,
+           res.bytes / (1024.0 * 1024.0) / elapsed, elapsed);
+    if (speed > 0) {
+        printf("Trace (scaled):   %.0f IOPS over %.3f s\n",
+               traceSec > 0 ? trace.count / (traceSec / speed) : 0, traceSec / speed);
+    }
+    printf("\nLatency:\n");
+    print_hist("read", &res.readLat);
+    print_hist("write", &res.writeLat);
+    if (speed > 0) {
+        printf("\nLag behind trace timestamps:\n");
+        print_hist("issue", &res.lag);
+        printf("  Finished %.3f s after the last trace timestamp\n", elapsed - traceSec / speed);
+    }
+
+    for (int i = 0; i < threads; i++) free(workers[i].buf);
+    free(workers);
+    free(ids);
+    free(r.inflight);
+    free(trace.records);
+    return res.errors ? 1 : 0;
+}